@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "../blobstore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+class BlobStoreTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSaveDeduplicates();
+    void testMigrateLegacyLayout();
+    void testCompact();
+};
+
+namespace
+{
+const QString s_fooUuid = QStringLiteral("0beec7b5ea3f0fdbc95d0dd47f3c5bc275da8a33");
+const QString s_barUuid = QStringLiteral("62cdb7020ff920e5aa642c3d4066950dd1f01f4d");
+
+QByteArray readAll(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+}
+
+void BlobStoreTest::testSaveDeduplicates()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString path = BlobStore::path(dir.path(), s_fooUuid);
+    QCOMPARE(path, dir.path() + QStringLiteral("/data/0b/") + s_fooUuid);
+    QVERIFY(BlobStore::save(dir.path(), s_fooUuid, QByteArrayLiteral("foo")));
+    QCOMPARE(readAll(path), QByteArrayLiteral("foo"));
+
+    // The same content is only stored once
+    QVERIFY(BlobStore::save(dir.path(), s_fooUuid, QByteArrayLiteral("foo")));
+    QCOMPARE(QDir(dir.filePath(QStringLiteral("data/0b"))).entryList(QDir::Files).size(), 1);
+}
+
+void BlobStoreTest::testMigrateLegacyLayout()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // Two items sharing the same data in the old per-item layout
+    for (const QString &itemUuid : {s_fooUuid, s_barUuid}) {
+        QVERIFY(QDir().mkpath(dir.filePath(QStringLiteral("data/") + itemUuid)));
+        QFile file(dir.filePath(QStringLiteral("data/") + itemUuid + u'/' + s_fooUuid));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArrayLiteral("foo"));
+    }
+
+    BlobStore::migrateLegacyLayout(dir.path());
+    QCOMPARE(readAll(BlobStore::path(dir.path(), s_fooUuid)), QByteArrayLiteral("foo"));
+    QCOMPARE(QDir(dir.filePath(QStringLiteral("data"))).entryList(QDir::Dirs | QDir::NoDotAndDotDot), QStringList{QStringLiteral("0b")});
+}
+
+void BlobStoreTest::testCompact()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(BlobStore::save(dir.path(), s_fooUuid, QByteArrayLiteral("foo")));
+    QVERIFY(BlobStore::save(dir.path(), s_barUuid, QByteArrayLiteral("bar")));
+
+    // Blobs written after the compaction started are kept even if they are not referenced yet
+    const QDateTime startTime = QDateTime::currentDateTimeUtc().addSecs(-60);
+    QCOMPARE(BlobStore::compact(dir.path(), {s_fooUuid}, startTime), qint64(0));
+    QVERIFY(QFile::exists(BlobStore::path(dir.path(), s_barUuid)));
+
+    QCOMPARE(BlobStore::compact(dir.path(), {s_fooUuid}, QDateTime::currentDateTimeUtc().addSecs(60)), qint64(3));
+    QVERIFY(QFile::exists(BlobStore::path(dir.path(), s_fooUuid)));
+    QVERIFY(!QFile::exists(BlobStore::path(dir.path(), s_barUuid)));
+}
+
+QTEST_GUILESS_MAIN(BlobStoreTest)
+#include "blobstoretest.moc"
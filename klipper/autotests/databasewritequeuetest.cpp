@@ -0,0 +1,123 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "../databasewritequeue.h"
+
+#include <QSqlQuery>
+#include <QTest>
+
+class DatabaseWriteQueueTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testFlush();
+    void testMaxDelay();
+    void testMaxQueued();
+    void testCoalesce();
+
+private:
+    int rowCount();
+    QString lastUsed(const QString &uuid);
+
+    QSqlDatabase m_db;
+};
+
+namespace
+{
+const QString s_insert = QStringLiteral("INSERT INTO main (uuid, last_used_time) VALUES (?, ?)");
+const QString s_update = QStringLiteral("UPDATE main SET last_used_time=? WHERE uuid=?");
+}
+
+void DatabaseWriteQueueTest::init()
+{
+    m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("writequeuetest"));
+    m_db.setDatabaseName(QStringLiteral(":memory:"));
+    QVERIFY(m_db.open());
+    QVERIFY(QSqlQuery(m_db).exec(QStringLiteral("CREATE TABLE main (uuid TEXT PRIMARY KEY, last_used_time TEXT)")));
+}
+
+void DatabaseWriteQueueTest::cleanup()
+{
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(QStringLiteral("writequeuetest"));
+}
+
+int DatabaseWriteQueueTest::rowCount()
+{
+    QSqlQuery query(QStringLiteral("SELECT COUNT(*) FROM main"), m_db);
+    return query.next() ? query.value(0).toInt() : -1;
+}
+
+QString DatabaseWriteQueueTest::lastUsed(const QString &uuid)
+{
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral("SELECT last_used_time FROM main WHERE uuid=?"));
+    query.addBindValue(uuid);
+    return query.exec() && query.next() ? query.value(0).toString() : QString();
+}
+
+void DatabaseWriteQueueTest::testFlush()
+{
+    DatabaseWriteQueue queue;
+    queue.setDatabase(m_db);
+    queue.enqueue(s_insert, {QStringLiteral("foo"), QStringLiteral("1")});
+    queue.enqueue(s_insert, {QStringLiteral("bar"), QStringLiteral("1")});
+    QCOMPARE(queue.size(), qsizetype(2));
+    QCOMPARE(rowCount(), 0);
+
+    QVERIFY(queue.flush());
+    QCOMPARE(queue.size(), qsizetype(0));
+    QCOMPARE(rowCount(), 2);
+
+    // A failing statement is reported but doesn't take the others down with it
+    queue.enqueue(s_insert, {QStringLiteral("foo"), QStringLiteral("2")});
+    queue.enqueue(s_insert, {QStringLiteral("baz"), QStringLiteral("2")});
+    QVERIFY(!queue.flush());
+    QCOMPARE(rowCount(), 3);
+}
+
+void DatabaseWriteQueueTest::testMaxDelay()
+{
+    DatabaseWriteQueue queue;
+    queue.setDatabase(m_db);
+    queue.enqueue(s_insert, {QStringLiteral("foo"), QStringLiteral("1")});
+    QCOMPARE(rowCount(), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(rowCount(), 1, int(DatabaseWriteQueue::s_maxDelay.count()) * 4);
+    QCOMPARE(queue.size(), qsizetype(0));
+}
+
+void DatabaseWriteQueueTest::testMaxQueued()
+{
+    DatabaseWriteQueue queue;
+    queue.setDatabase(m_db);
+    for (qsizetype i = 0; i < DatabaseWriteQueue::s_maxQueued; ++i) {
+        queue.enqueue(s_insert, {QString::number(i), QStringLiteral("1")});
+    }
+    QCOMPARE(queue.size(), qsizetype(0));
+    QCOMPARE(rowCount(), int(DatabaseWriteQueue::s_maxQueued));
+}
+
+void DatabaseWriteQueueTest::testCoalesce()
+{
+    {
+        DatabaseWriteQueue queue;
+        queue.setDatabase(m_db);
+        queue.enqueue(s_insert, {QStringLiteral("foo"), QStringLiteral("1")});
+        for (int i = 2; i <= 10; ++i) {
+            queue.enqueue(s_update, {QString::number(i), QStringLiteral("foo")}, QStringLiteral("last_used_time:foo"));
+        }
+        queue.enqueue(s_update, {QStringLiteral("1"), QStringLiteral("bar")}, QStringLiteral("last_used_time:bar"));
+        QCOMPARE(queue.size(), qsizetype(3));
+    }
+    // Flushed when the queue goes away
+    QCOMPARE(lastUsed(QStringLiteral("foo")), QStringLiteral("10"));
+}
+
+QTEST_GUILESS_MAIN(DatabaseWriteQueueTest)
+#include "databasewritequeuetest.moc"
@@ -0,0 +1,215 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "../historycycler.h"
+#include "../historyitem.h"
+#include "../historymodel.h"
+
+#include <QCryptographicHash>
+#include <QImage>
+#include <QMimeData>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+using namespace Qt::StringLiterals;
+
+/**
+ * Benchmarks of the history operations that run on every clipboard change,
+ * every keystroke in the popup and at startup.
+ */
+class HistoryBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkInsert_data();
+    void benchmarkInsert();
+    void benchmarkMoveToTop();
+    void benchmarkData_data();
+    void benchmarkData();
+    void benchmarkLoadHistory_data();
+    void benchmarkLoadHistory();
+    void benchmarkCycle();
+
+private:
+    /**
+     * Replaces the history with @p count text items written straight to the database, then loads them
+     */
+    void populate(int count);
+    void waitForIdle();
+
+    QTemporaryDir m_dbFolder;
+    std::shared_ptr<HistoryModel> m_model;
+    QImage m_image;
+    int m_serial = 0;
+};
+
+void HistoryBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dbFolder.isValid());
+    qputenv("KLIPPER_DATABASE", m_dbFolder.filePath(u"history3.sqlite"_s).toLocal8Bit());
+
+    m_image = QImage(512, 512, QImage::Format_RGB32);
+    m_image.fill(Qt::darkCyan);
+
+    m_model = HistoryModel::self();
+    m_model->setMaxSize(100000);
+    m_model->clear();
+    waitForIdle();
+}
+
+void HistoryBenchmark::cleanupTestCase()
+{
+    m_model->clear();
+    waitForIdle();
+    m_model.reset();
+}
+
+void HistoryBenchmark::populate(int count)
+{
+    m_model->clear();
+    waitForIdle();
+    m_model->setMaxSize(count);
+
+    QSqlDatabase db = QSqlDatabase::database(u"klipper"_s);
+    QVERIFY(db.transaction());
+    QSqlQuery mainQuery(db);
+    QVERIFY(mainQuery.prepare(u"INSERT INTO main (uuid, added_time, last_used_time, mimetypes, text, starred) VALUES (?, ?, ?, ?, ?, ?)"_s));
+    QSqlQuery auxQuery(db);
+    QVERIFY(auxQuery.prepare(u"INSERT INTO aux (uuid, mimetype, data_uuid) VALUES (?, ?, ?)"_s));
+    for (int i = 0; i < count; ++i) {
+        const QString text = u"History item %1 with a line of text long enough to be elided in the popup"_s.arg(i);
+        const QString uuid = QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex());
+        mainQuery.addBindValue(uuid);
+        mainQuery.addBindValue(qreal(i + 1));
+        mainQuery.addBindValue(qreal(i + 1));
+        mainQuery.addBindValue(u"text/plain"_s);
+        mainQuery.addBindValue(text);
+        mainQuery.addBindValue(i % 100 == 0);
+        QVERIFY2(mainQuery.exec(), qPrintable(mainQuery.lastError().text()));
+        auxQuery.addBindValue(uuid);
+        auxQuery.addBindValue(u"text/plain"_s);
+        auxQuery.addBindValue(uuid);
+        QVERIFY2(auxQuery.exec(), qPrintable(auxQuery.lastError().text()));
+    }
+    QVERIFY(db.commit());
+
+    QVERIFY(m_model->loadHistory());
+    QCOMPARE(m_model->rowCount(), count);
+}
+
+void HistoryBenchmark::waitForIdle()
+{
+    while (m_model->pendingJobs() > 0) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+}
+
+void HistoryBenchmark::benchmarkInsert_data()
+{
+    QTest::addColumn<QString>("type");
+    QTest::newRow("text") << u"text"_s;
+    QTest::newRow("url") << u"url"_s;
+    QTest::newRow("image") << u"image"_s;
+}
+
+void HistoryBenchmark::benchmarkInsert()
+{
+    QFETCH(QString, type);
+    populate(1000);
+    // Only the time spent in insert() blocks the GUI thread, saving the clip runs in the background
+    QBENCHMARK {
+        // Every payload must be unique, otherwise the model only moves the existing item to the top
+        auto data = std::make_unique<QMimeData>();
+        const int serial = ++m_serial;
+        if (type == u"text") {
+            data->setText(u"Lorem ipsum dolor sit amet %1"_s.arg(serial));
+        } else if (type == u"url") {
+            data->setUrls({QUrl(u"https://kde.org/%1"_s.arg(serial)), QUrl(u"file:///home/user/Documents/%1.odt"_s.arg(serial))});
+        } else {
+            QImage image = m_image;
+            image.setPixel(0, 0, serial);
+            data->setImageData(image);
+        }
+        m_model->insert(data.get());
+    }
+    waitForIdle();
+}
+
+void HistoryBenchmark::benchmarkMoveToTop()
+{
+    populate(1000);
+    QBENCHMARK {
+        // The last row is the worst case for the position index
+        m_model->moveToTop(m_model->index(m_model->rowCount() - 1).data(HistoryModel::UuidRole).toString());
+    }
+    waitForIdle();
+}
+
+void HistoryBenchmark::benchmarkData_data()
+{
+    QTest::addColumn<int>("role");
+    const QHash<int, QByteArray> roleNames = m_model->roleNames();
+    for (auto it = roleNames.cbegin(); it != roleNames.cend(); ++it) {
+        QTest::newRow(it.value().constData()) << it.key();
+    }
+}
+
+void HistoryBenchmark::benchmarkData()
+{
+    QFETCH(int, role);
+    populate(1000);
+    // What a view does when it scrolls through the whole history
+    QBENCHMARK {
+        for (int row = 0, count = m_model->rowCount(); row < count; ++row) {
+            m_model->data(m_model->index(row), role);
+        }
+    }
+}
+
+void HistoryBenchmark::benchmarkLoadHistory_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("50k") << 50000;
+}
+
+void HistoryBenchmark::benchmarkLoadHistory()
+{
+    QFETCH(int, count);
+    populate(count);
+    QBENCHMARK {
+        m_model->loadHistory();
+    }
+    QCOMPARE(m_model->rowCount(), count);
+}
+
+void HistoryBenchmark::benchmarkCycle()
+{
+    populate(1000);
+    HistoryCycler cycler(nullptr);
+    // Walk to the end of the history and back, like holding the cycle shortcuts
+    QBENCHMARK {
+        while (cycler.nextInCycle()) {
+            cycler.cycleNext();
+        }
+        while (cycler.prevInCycle()) {
+            cycler.cyclePrev();
+        }
+    }
+    waitForIdle();
+}
+
+QTEST_MAIN(HistoryBenchmark)
+#include "historybenchmark.moc"
@@ -16,6 +16,7 @@
 #include <KConfigGroup>
 #include <KCoreConfigSkeleton>
 #include <KSharedConfig>
+#include <KSystemClipboard>
 
 class HistoryModelTest : public QObject
 {
@@ -26,6 +27,11 @@ private Q_SLOTS:
     void testInsertRemove();
     void testClear();
     void testIndexOf();
+    void testSearch();
+    void testByteBudget();
+    void testPreview();
+    void testInsertLargeText();
+    void testRestoreAfterInsert();
     void testType_data();
     void testType();
     void testKeepClipboardContents();
@@ -168,11 +174,213 @@ void HistoryModelTest::testIndexOf()
     QVERIFY(history->indexOf(fooUuid) >= 0);
     QCOMPARE(history->index(history->indexOf(fooUuid)).data(HistoryModel::UuidRole).toString(), fooUuid);
 
+    // The uuid index must follow every kind of row move and removal
+    auto verifyIndex = [&history] {
+        for (int row = 0; row < history->rowCount(); ++row) {
+            QCOMPARE(history->indexOf(history->index(row).data(HistoryModel::UuidRole).toString()), row);
+        }
+    };
+    const QStringList texts{QStringLiteral("bar"), QStringLiteral("foobar"), QStringLiteral("baz"), QStringLiteral("qux"), QStringLiteral("quux")};
+    for (const QString &text : texts) {
+        QVERIFY(history->insert(text));
+    }
+    verifyIndex();
+    history->moveTopToBack();
+    verifyIndex();
+    history->moveBackToTop();
+    verifyIndex();
+    history->moveToTop(fooUuid);
+    QCOMPARE(history->indexOf(fooUuid), 0);
+    verifyIndex();
+    history->moveToTop(history->index(2).data(HistoryModel::UuidRole).toString());
+    verifyIndex();
+    QVERIFY(history->removeRow(1));
+    verifyIndex();
+    QVERIFY(history->removeRow(history->rowCount() - 2));
+    verifyIndex();
+
     history->clear();
     QTRY_COMPARE(history->pendingJobs(), 0);
     QVERIFY(history->indexOf(fooUuid) < 0);
 }
 
+void HistoryModelTest::testSearch()
+{
+    std::shared_ptr<HistoryModel> history = HistoryModel::self();
+    history->setMaxSize(10);
+    QCOMPARE(history->rowCount(), 0);
+
+    const QStringList texts{QStringLiteral("Hello World"), QStringLiteral("world peace"), QStringLiteral("say \"hello\"")};
+    for (const QString &text : texts) {
+        QVERIFY(history->insert(text));
+    }
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    auto uuidOf = [](const QString &text) {
+        return QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex());
+    };
+
+    // The search only sees the rows that are written
+    QVERIFY(history->saveClipboardHistory());
+    auto search = [&history](const QString &text) {
+        std::optional<HistoryModel::SearchResult> result = history->search(text).result();
+        return result.has_value() ? std::optional<QStringList>(result->uuids) : std::nullopt;
+    };
+    QCOMPARE(history->search(QStringLiteral("nothing")).result()->searchedUuids, (QSet<QString>{uuidOf(texts[0]), uuidOf(texts[1]), uuidOf(texts[2])}));
+
+    std::optional<QStringList> result = search(QStringLiteral("WORL"));
+    QVERIFY(result.has_value());
+    QCOMPARE(QSet<QString>(result->cbegin(), result->cend()), (QSet<QString>{uuidOf(texts[0]), uuidOf(texts[1])}));
+    // Too short for the trigram index, searched in the main table instead
+    result = search(QStringLiteral("Wo"));
+    QCOMPARE(QSet<QString>(result->cbegin(), result->cend()), (QSet<QString>{uuidOf(texts[0]), uuidOf(texts[1])}));
+    QCOMPARE(search(QStringLiteral("%")), QStringList{});
+    QCOMPARE(search(QStringLiteral("\"hello\"")), QStringList{uuidOf(texts[2])});
+    QCOMPARE(search(QStringLiteral("nothing")), QStringList{});
+
+    // Edits and removals must reach the index
+    QVERIFY(history->setData(history->index(history->indexOf(uuidOf(texts[1]))), QStringLiteral("war and peace"), Qt::DisplayRole));
+    QCOMPARE(search(QStringLiteral("world")), QStringList{uuidOf(texts[0])});
+    QCOMPARE(search(QStringLiteral("peace")), QStringList{uuidOf(QStringLiteral("war and peace"))});
+    QVERIFY(history->remove(uuidOf(texts[0])));
+    QVERIFY(history->saveClipboardHistory());
+    QCOMPARE(search(QStringLiteral("world")), QStringList{});
+
+    history->clear();
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    QCOMPARE(search(QStringLiteral("peace")), QStringList{});
+}
+
+void HistoryModelTest::testByteBudget()
+{
+    std::shared_ptr<HistoryModel> history = HistoryModel::self();
+    std::unique_ptr<QAbstractItemModelTester> modelTest(new QAbstractItemModelTester(history.get()));
+    history->setMaxSize(100);
+    history->setMaxBytes(450);
+    QCOMPARE(history->rowCount(), 0);
+
+    // 100 bytes each
+    QStringList texts;
+    for (int i = 0; i < 6; ++i) {
+        texts.emplace_back(QString::number(i).repeated(100));
+    }
+    QVERIFY(history->insert(texts[0]));
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    QVERIFY(history->setData(history->index(0), true, HistoryModel::StarredRole));
+    QCOMPARE(history->stats().dataBytes, qint64(100));
+
+    for (int i = 1; i < texts.size(); ++i) {
+        QVERIFY(history->insert(texts[i]));
+        QTRY_COMPARE(history->pendingJobs(), 0);
+    }
+    // The least recently used items are removed first, the starred one stays
+    QCOMPARE(history->rowCount(), 4);
+    QCOMPARE(history->data(history->index(0)).toString(), texts[5]);
+    QCOMPARE(history->data(history->index(1)).toString(), texts[4]);
+    QCOMPARE(history->data(history->index(2)).toString(), texts[3]);
+    QCOMPARE(history->data(history->index(3)).toString(), texts[0]);
+
+    // The texts are saved, only the text cache holds them once their rows are written
+    QTRY_COMPARE(history->stats().residentTextBytes, qint64(0));
+    HistoryModel::Stats stats = history->stats();
+    QCOMPARE(stats.items, qsizetype(4));
+    QCOMPARE(stats.starredItems, 1);
+    QCOMPARE(stats.dataBytes, qint64(400));
+    QCOMPARE(stats.maxBytes, qint64(450));
+    QCOMPARE(stats.cachedTextBytes, 4 * 100 * qint64(sizeof(QChar)));
+
+    // Neither the top item nor the starred one can be removed to get under the limit
+    history->setMaxBytes(150);
+    QCOMPARE(history->rowCount(), 2);
+    QCOMPARE(history->data(history->index(0)).toString(), texts[5]);
+    QCOMPARE(history->data(history->index(1)).toString(), texts[0]);
+    QCOMPARE(history->stats().dataBytes, qint64(200));
+
+    history->setMaxBytes(0);
+    history->clear();
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    QCOMPARE(history->stats().dataBytes, qint64(0));
+}
+
+void HistoryModelTest::testPreview()
+{
+    std::shared_ptr<HistoryModel> history = HistoryModel::self();
+    std::unique_ptr<QAbstractItemModelTester> modelTest(new QAbstractItemModelTester(history.get()));
+    history->setMaxSize(10);
+    QCOMPARE(history->rowCount(), 0);
+
+    const QString text = QStringLiteral("a").repeated(HistoryItem::s_previewLength) + QStringLiteral("b");
+    QVERIFY(history->insert(text));
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    QTRY_COMPARE(history->stats().residentTextBytes, qint64(0));
+
+    // Qt::DisplayRole only has the preview, TextRole has the whole text
+    QCOMPARE(history->data(history->index(0)).toString(), text.left(HistoryItem::s_previewLength));
+    QCOMPARE(history->data(history->index(0), HistoryModel::TextRole).toString(), text);
+
+    history->clear();
+    QTRY_COMPARE(history->pendingJobs(), 0);
+}
+
+void HistoryModelTest::testInsertLargeText()
+{
+    std::shared_ptr<HistoryModel> history = HistoryModel::self();
+    std::unique_ptr<QAbstractItemModelTester> modelTest(new QAbstractItemModelTester(history.get()));
+    history->setMaxSize(10);
+    QCOMPARE(history->rowCount(), 0);
+
+    // Hashed on a worker thread, the row shows up right away and gets its uuid later
+    const QString text = QStringLiteral("0123456789").repeated(10 * 1000);
+    const QString uuid = QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex());
+    SystemClipboard::self()->clear();
+    QVERIFY(history->insert(text));
+    QCOMPARE(history->rowCount(), 1);
+    QCOMPARE(history->data(history->index(0), HistoryModel::TextRole).toString(), text);
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    QCOMPARE(history->indexOf(uuid), 0);
+    // Once saved, the top item goes to the clipboard like any other
+    QTRY_COMPARE(
+        [] {
+            const QMimeData *data = KSystemClipboard::instance()->mimeData(QClipboard::Clipboard);
+            return data ? data->text() : QString();
+        }(),
+        text);
+
+    // The same text again is moved to the top instead of added twice
+    QVERIFY(history->insert(QStringLiteral("foo")));
+    QVERIFY(history->insert(text));
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    QCOMPARE(history->rowCount(), 2);
+    QCOMPARE(history->indexOf(uuid), 0);
+
+    history->clear();
+    QTRY_COMPARE(history->pendingJobs(), 0);
+}
+
+void HistoryModelTest::testRestoreAfterInsert()
+{
+    std::shared_ptr<HistoryModel> history = HistoryModel::self();
+    history->setMaxSize(10);
+    QCOMPARE(history->rowCount(), 0);
+
+    auto clipboardText = [] {
+        const QMimeData *data = KSystemClipboard::instance()->mimeData(QClipboard::Clipboard);
+        return data ? data->text() : QString();
+    };
+
+    // The rows of the item are saved, but may still be in the write queue
+    const QString text = QStringLiteral("restore me");
+    QVERIFY(history->insert(text));
+    QTRY_COMPARE(history->pendingJobs(), 0);
+    SystemClipboard::self()->clear();
+    QVERIFY(clipboardText().isEmpty());
+
+    SystemClipboard::self()->setMimeData(history->first(), SystemClipboard::Clipboard);
+    QTRY_COMPARE(clipboardText(), text);
+
+    history->clear();
+    QTRY_COMPARE(history->pendingJobs(), 0);
+}
+
 void HistoryModelTest::testType_data()
 {
     QTest::addColumn<std::shared_ptr<QMimeData>>("item");
@@ -231,6 +439,9 @@ void HistoryModelTest::testKeepClipboardContents()
         qDebug() << "Stage 2";
         std::shared_ptr<HistoryModel> history = HistoryModel::self();
         QCOMPARE(history->rowCount(), 1);
+        // Restored without the text, which is loaded on demand
+        QCOMPARE(history->index(0).data(HistoryModel::TypeRole).value<HistoryItemType>(), HistoryItemType::Text);
+        QCOMPARE(history->index(0).data().toString(), QLatin1String("foo"));
 
         setKeepClipboardContents(false);
     }
@@ -252,7 +463,7 @@ void HistoryModelTest::testKeepClipboardContents()
         QTRY_COMPARE(history->pendingJobs(), 0);
         dataDir.refresh();
         qDebug() << dataDir.entryList();
-        QCOMPARE(dataDir.entryList().size(), 3); // QList(".", "..", "8843d7f92416211de9ebb963ff4ce28125932878")
+        QCOMPARE(dataDir.entryList().size(), 3); // QList(".", "..", "88") holding 8843d7f92416211de9ebb963ff4ce28125932878
 
         setKeepClipboardContents(true);
     }
@@ -0,0 +1,152 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "../historymodel.h"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMimeData>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace
+{
+constexpr int s_iterations = 10;
+}
+
+/**
+ * Measures how long a clipboard change keeps the GUI thread busy (insert)
+ * and how long it takes until the clip is fully saved (copy to idle).
+ */
+class IngestBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkInsert_data();
+    void benchmarkInsert();
+    void benchmarkCopyToIdle_data();
+    void benchmarkCopyToIdle();
+
+private:
+    void addPayloadRows();
+    std::unique_ptr<QMimeData> createPayload(const QString &type, int serial);
+    void waitForIdle();
+
+    QTemporaryDir m_dbFolder;
+    std::shared_ptr<HistoryModel> m_model;
+    QImage m_image;
+    QString m_html;
+    int m_serial = 0;
+};
+
+void IngestBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dbFolder.isValid());
+    qputenv("KLIPPER_DATABASE", m_dbFolder.filePath(QStringLiteral("history3.sqlite")).toLocal8Bit());
+
+    m_image = QImage(3840, 2160, QImage::Format_RGB32);
+    for (int y = 0; y < m_image.height(); ++y) {
+        auto line = reinterpret_cast<QRgb *>(m_image.scanLine(y));
+        for (int x = 0; x < m_image.width(); ++x) {
+            line[x] = qRgb(x % 256, y % 256, (x ^ y) % 256);
+        }
+    }
+
+    const QString row = QStringLiteral("<tr><td>cell</td><td><b>bold</b></td><td><a href=\"https://kde.org\">link</a></td></tr>");
+    m_html = QStringLiteral("<html><body><table>") + row.repeated(5 * 1000 * 1000 / row.size()) + QStringLiteral("</table></body></html>");
+
+    m_model = HistoryModel::self();
+    m_model->setMaxSize(100000);
+    m_model->clear();
+    waitForIdle();
+}
+
+void IngestBenchmark::cleanupTestCase()
+{
+    m_model->clear();
+    waitForIdle();
+    m_model.reset();
+}
+
+void IngestBenchmark::addPayloadRows()
+{
+    QTest::addColumn<QString>("type");
+    QTest::newRow("text") << QStringLiteral("text");
+    QTest::newRow("4K image") << QStringLiteral("image");
+    QTest::newRow("5MB HTML") << QStringLiteral("html");
+}
+
+std::unique_ptr<QMimeData> IngestBenchmark::createPayload(const QString &type, int serial)
+{
+    // Every payload must be unique, otherwise the model only moves the existing item to the top
+    auto data = std::make_unique<QMimeData>();
+    if (type == QLatin1String("text")) {
+        data->setText(QStringLiteral("Lorem ipsum dolor sit amet %1").arg(serial));
+    } else if (type == QLatin1String("image")) {
+        QImage image = m_image;
+        image.setPixel(0, 0, serial);
+        data->setImageData(image);
+    } else {
+        data->setHtml(m_html + QString::number(serial));
+        data->setText(QStringLiteral("table %1").arg(serial));
+    }
+    return data;
+}
+
+void IngestBenchmark::waitForIdle()
+{
+    while (m_model->pendingJobs() > 0) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+}
+
+void IngestBenchmark::benchmarkInsert_data()
+{
+    addPayloadRows();
+}
+
+void IngestBenchmark::benchmarkInsert()
+{
+    QFETCH(QString, type);
+    // Only the time spent in insert() blocks the GUI thread, saving the clip runs in the background
+    qint64 elapsed = 0;
+    for (int i = 0; i < s_iterations; ++i) {
+        std::unique_ptr<QMimeData> data = createPayload(type, ++m_serial);
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(m_model->insert(data.get()));
+        elapsed += timer.nsecsElapsed();
+        waitForIdle();
+    }
+    QTest::setBenchmarkResult(elapsed / 1e6 / s_iterations, QTest::WalltimeMilliseconds);
+}
+
+void IngestBenchmark::benchmarkCopyToIdle_data()
+{
+    addPayloadRows();
+}
+
+void IngestBenchmark::benchmarkCopyToIdle()
+{
+    QFETCH(QString, type);
+    qint64 elapsed = 0;
+    for (int i = 0; i < s_iterations; ++i) {
+        std::unique_ptr<QMimeData> data = createPayload(type, ++m_serial);
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(m_model->insert(data.get()));
+        waitForIdle();
+        elapsed += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(elapsed / 1e6 / s_iterations, QTest::WalltimeMilliseconds);
+}
+
+QTEST_MAIN(IngestBenchmark)
+#include "ingestbenchmark.moc"
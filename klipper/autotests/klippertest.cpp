@@ -93,6 +93,7 @@ void KlipperTest::testBug465225()
                                  "8f9353dabfdcf9aca5a901cd2c4ae6717cac5adc")));
         clipboard->setMimeData(data, QClipboard::Clipboard);
         QTRY_COMPARE(model->first()->type(), HistoryItemType::Image);
+        QTRY_COMPARE(model->pendingJobs(), 0); // The image is hashed and deduplicated in the background
         QCOMPARE(model->rowCount(), 2);
     }
 
@@ -0,0 +1,113 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "../blobstore.h"
+#include "../thumbnailcache.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QTest>
+
+class ThumbnailCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testBucket_data();
+    void testBucket();
+    void testGenerate();
+    void testLoadGeneratesMissingThumbnail();
+    void testCompactRemovesThumbnails();
+};
+
+namespace
+{
+const QString s_imageUuid = QStringLiteral("0beec7b5ea3f0fdbc95d0dd47f3c5bc275da8a33");
+
+QImage createImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    return image;
+}
+
+bool saveBlob(const QString &dbFolder, const QImage &image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    return buffer.open(QIODevice::WriteOnly) && image.save(&buffer, "PNG") && BlobStore::save(dbFolder, s_imageUuid, data);
+}
+}
+
+void ThumbnailCacheTest::testBucket_data()
+{
+    QTest::addColumn<QSize>("requestedSize");
+    QTest::addColumn<int>("expectedBucket");
+
+    QTest::newRow("invalid") << QSize() << 512;
+    QTest::newRow("small") << QSize(64, 40) << 128;
+    QTest::newRow("exact") << QSize(256, 100) << 256;
+    QTest::newRow("height only") << QSize(0, 300) << 512;
+    QTest::newRow("larger than all buckets") << QSize(2000, 1000) << 512;
+}
+
+void ThumbnailCacheTest::testBucket()
+{
+    QFETCH(QSize, requestedSize);
+    QFETCH(int, expectedBucket);
+    QCOMPARE(ThumbnailCache::bucket(requestedSize), expectedBucket);
+}
+
+void ThumbnailCacheTest::testGenerate()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // Only the buckets smaller than the image get a thumbnail
+    ThumbnailCache::generate(dir.path(), s_imageUuid, createImage(QSize(400, 200)));
+    QCOMPARE(QImage(ThumbnailCache::path(dir.path(), s_imageUuid, 128)).size(), QSize(128, 64));
+    QCOMPARE(QImage(ThumbnailCache::path(dir.path(), s_imageUuid, 256)).size(), QSize(256, 128));
+    QVERIFY(!QFile::exists(ThumbnailCache::path(dir.path(), s_imageUuid, 512)));
+
+    QCOMPARE(ThumbnailCache::load(dir.path(), s_imageUuid, QSize(0, 32)).size(), QSize(64, 32));
+    QCOMPARE(ThumbnailCache::load(dir.path(), s_imageUuid, QSize(200, 200)).size(), QSize(200, 100));
+}
+
+void ThumbnailCacheTest::testLoadGeneratesMissingThumbnail()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(ThumbnailCache::load(dir.path(), s_imageUuid, QSize(64, 64)).isNull());
+
+    // An image saved before the thumbnail cache existed
+    QVERIFY(saveBlob(dir.path(), createImage(QSize(1000, 500))));
+    QVERIFY(!QFile::exists(ThumbnailCache::path(dir.path(), s_imageUuid, 128)));
+    QCOMPARE(ThumbnailCache::load(dir.path(), s_imageUuid, QSize(100, 100)).size(), QSize(100, 50));
+    QCOMPARE(QImage(ThumbnailCache::path(dir.path(), s_imageUuid, 128)).size(), QSize(128, 64));
+}
+
+void ThumbnailCacheTest::testCompactRemovesThumbnails()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QImage image = createImage(QSize(1000, 500));
+    QVERIFY(saveBlob(dir.path(), image));
+    ThumbnailCache::generate(dir.path(), s_imageUuid, image);
+
+    const QDateTime later = QDateTime::currentDateTimeUtc().addSecs(60);
+    BlobStore::compact(dir.path(), {s_imageUuid}, later);
+    QVERIFY(QFile::exists(ThumbnailCache::path(dir.path(), s_imageUuid, 128)));
+
+    BlobStore::compact(dir.path(), {}, later);
+    QVERIFY(!QFile::exists(BlobStore::path(dir.path(), s_imageUuid)));
+    for (int bucket : ThumbnailCache::s_buckets) {
+        QVERIFY(!QFile::exists(ThumbnailCache::path(dir.path(), s_imageUuid, bucket)));
+    }
+}
+
+QTEST_GUILESS_MAIN(ThumbnailCacheTest)
+#include "thumbnailcachetest.moc"
@@ -0,0 +1,102 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "../urlgrabber.h"
+
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KService>
+#include <KSycoca>
+
+class URLGrabberTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testMatchingActions();
+    void testMimeServicesCache();
+
+private:
+    /**
+     * The configured actions matching @p clipData. The descriptions of the commands
+     * of the MIME type actions that match as well go to @p mimeCommands.
+     */
+    ActionList matchingActions(URLGrabber &grabber, const QString &clipData, bool automatically, QStringList *mimeCommands = nullptr);
+};
+
+void URLGrabberTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+ActionList URLGrabberTest::matchingActions(URLGrabber &grabber, const QString &clipData, bool automatically, QStringList *mimeCommands)
+{
+    ActionList actions;
+    const ActionList matches = grabber.matchingActions(clipData, automatically);
+    for (ClipAction *action : matches) {
+        if (grabber.actionList().contains(action)) {
+            actions.append(action);
+            continue;
+        }
+        // The MIME type actions are made anew for every match
+        for (const ClipCommand &command : action->commands()) {
+            if (mimeCommands) {
+                mimeCommands->append(command.description);
+            }
+        }
+        delete action;
+    }
+    grabber.m_myMatches.clear();
+    return actions;
+}
+
+void URLGrabberTest::testMatchingActions()
+{
+    URLGrabber grabber(nullptr);
+    auto automatic = new ClipAction(QStringLiteral("^https?://([^/]+)"), QStringLiteral("Web address"), true);
+    auto manual = new ClipAction(QStringLiteral("^ftp://"), QStringLiteral("FTP address"), false);
+    grabber.setActionList({automatic, manual});
+
+    QVERIFY(matchingActions(grabber, QStringLiteral("foo bar"), false).isEmpty());
+
+    QCOMPARE(matchingActions(grabber, QStringLiteral("https://kde.org/"), true), ActionList{automatic});
+    QCOMPARE(automatic->actionCapturedTexts(), (QStringList{QStringLiteral("https://kde.org"), QStringLiteral("kde.org")}));
+
+    // Actions that aren't automatic only match when invoked by hand
+    QVERIFY(matchingActions(grabber, QStringLiteral("ftp://kde.org/"), true).isEmpty());
+    QCOMPARE(matchingActions(grabber, QStringLiteral("ftp://kde.org/"), false), ActionList{manual});
+}
+
+void URLGrabberTest::testMimeServicesCache()
+{
+    URLGrabber grabber(nullptr);
+    const QString url = QStringLiteral("https://kde.org/");
+
+    // Web addresses are treated as HTML, the applications for it are looked up once
+    matchingActions(grabber, url, false);
+    QVERIFY(grabber.m_mimeServices.contains(QStringLiteral("text/html")));
+
+    // Later matches use the cached applications
+    const QString fakeName = QStringLiteral("Fake Browser");
+    grabber.m_mimeServices.insert(QStringLiteral("text/html"), {KService::Ptr(new KService(fakeName, QStringLiteral("fakebrowser %u"), QString()))});
+    for (int i = 0; i < 2; ++i) {
+        QStringList mimeCommands;
+        matchingActions(grabber, url, false, &mimeCommands);
+        QCOMPARE(mimeCommands, QStringList{fakeName});
+    }
+
+    // Installed or removed applications drop the cache
+    Q_EMIT KSycoca::self()->databaseChanged();
+    QVERIFY(grabber.m_mimeServices.isEmpty());
+    QStringList mimeCommands;
+    matchingActions(grabber, url, false, &mimeCommands);
+    QVERIFY(!mimeCommands.contains(fakeName));
+    QVERIFY(grabber.m_mimeServices.contains(QStringLiteral("text/html")));
+}
+
+QTEST_MAIN(URLGrabberTest)
+#include "urlgrabbertest.moc"
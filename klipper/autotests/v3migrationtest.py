@@ -51,9 +51,9 @@ class V3MigrationTest(unittest.TestCase):
             self.assertTrue(os.path.exists(os.path.join(temp_dir, "data")))
             self.assertTrue(os.path.exists(target_db))
             for uuid, result in (("230aa750d982a8e1a7e8f0b7ccc4e4b1b87bf593", "Fushan Wen"), ("e2ab8561c5a8f9967e62486c44211c63bcf7d002", "clipboard")):
-                self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid)))
-                self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid, uuid)))
-                with open(os.path.join(temp_dir, "data", uuid, uuid), encoding="utf-8") as fh:
+                self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid[:2])))
+                self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid[:2], uuid)))
+                with open(os.path.join(temp_dir, "data", uuid[:2], uuid), encoding="utf-8") as fh:
                     self.assertEqual(fh.readline(), result)
 
             con = sqlite3.connect(target_db)
@@ -84,9 +84,9 @@ class V3MigrationTest(unittest.TestCase):
             self.assertTrue(os.path.exists(target_db))
             self.assertTrue(os.path.exists(os.path.join(temp_dir, "data")))
             uuid = "8f9353dabfdcf9aca5a901cd2c4ae6717cac5adc"
-            self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid)))
-            self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid, uuid)))
-            pixbuf = GdkPixbuf.Pixbuf.new_from_file(os.path.join(temp_dir, "data", uuid, uuid))
+            self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid[:2])))
+            self.assertTrue(os.path.exists(os.path.join(temp_dir, "data", uuid[:2], uuid)))
+            pixbuf = GdkPixbuf.Pixbuf.new_from_file(os.path.join(temp_dir, "data", uuid[:2], uuid))
             self.assertIsNotNone(pixbuf)
             self.assertEqual(pixbuf.get_width(), 1610)
             self.assertEqual(pixbuf.get_height(), 1329)
@@ -0,0 +1,107 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "blobstore.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+
+#include "klipper_debug.h"
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr qsizetype s_uuidLength = 40; // SHA1
+constexpr qsizetype s_fanOutLength = 2;
+// Held by save() while reusing a stored blob and by compact() while deleting one
+QMutex s_reuseMutex;
+}
+
+QString BlobStore::path(QStringView dbFolder, QStringView dataUuid)
+{
+    return dbFolder + u"/data/" + dataUuid.left(s_fanOutLength) + u'/' + dataUuid;
+}
+
+bool BlobStore::save(QStringView dbFolder, QStringView dataUuid, const QByteArray &data, QString *errorString)
+{
+    const QString filePath = path(dbFolder, dataUuid);
+    {
+        QMutexLocker locker(&s_reuseMutex);
+        if (QFile file(filePath); file.open(QIODevice::ReadOnly)) {
+            // Already stored. Bump the modification time so a running compaction doesn't
+            // delete it before the new reference is in the database.
+            file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+            return true;
+        }
+    }
+
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath())) [[unlikely]] {
+        if (errorString) {
+            *errorString = u"Failed to create the folder for "_s + filePath;
+        }
+        return false;
+    }
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+void BlobStore::migrateLegacyLayout(QStringView dbFolder)
+{
+    QDir dataDir(dbFolder + u"/data");
+    const QStringList itemFolders = dataDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &itemUuid : itemFolders) {
+        if (itemUuid.size() != s_uuidLength) {
+            continue; // Already a fan-out folder
+        }
+        QDir itemDir(dataDir.filePath(itemUuid));
+        const QStringList blobs = itemDir.entryList(QDir::Files);
+        for (const QString &dataUuid : blobs) {
+            const QString target = path(dbFolder, dataUuid);
+            QDir().mkpath(QFileInfo(target).absolutePath());
+            if (!QFile::rename(itemDir.filePath(dataUuid), target)) {
+                // Another item already brought the same content
+                QFile::remove(itemDir.filePath(dataUuid));
+            }
+        }
+        if (!itemDir.removeRecursively()) {
+            qCWarning(KLIPPER_LOG) << "Failed to remove" << itemDir.absolutePath();
+        }
+    }
+}
+
+qint64 BlobStore::compact(QStringView dbFolder, const QSet<QString> &referencedUuids, const QDateTime &startTime)
+{
+    qint64 reclaimed = 0;
+    QDirIterator it(dbFolder + u"/data", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QFileInfo info = it.nextFileInfo();
+        // Thumbnails are named after the blob they were made from, and go with it
+        if (referencedUuids.contains(info.completeBaseName()) || info.lastModified() >= startTime) {
+            continue;
+        }
+        const qint64 size = info.size();
+        QMutexLocker locker(&s_reuseMutex);
+        // save() may have reused the blob since it was listed
+        if (QFileInfo(info.absoluteFilePath()).lastModified() >= startTime) {
+            continue;
+        }
+        if (QFile::remove(info.absoluteFilePath())) {
+            reclaimed += size;
+        }
+    }
+    return reclaimed;
+}
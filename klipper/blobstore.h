@@ -0,0 +1,51 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QSet>
+#include <QString>
+
+#include "klipper_export.h"
+
+/**
+ * Content-addressed storage for clip data.
+ *
+ * Every blob is stored once under its data uuid (the SHA1 of its content) in
+ * data/<first two characters>/<data uuid>, no matter how many history items
+ * refer to it. The rows in the aux table are the references: removing an item
+ * only removes its aux rows, and compact() later deletes the blobs that are no
+ * longer referenced.
+ */
+class KLIPPER_EXPORT BlobStore
+{
+public:
+    /**
+     * @return the path of the blob @p dataUuid in the database folder @p dbFolder
+     */
+    static QString path(QStringView dbFolder, QStringView dataUuid);
+
+    /**
+     * Saves @p data under @p dataUuid unless the blob is already stored.
+     * Safe to call from any thread.
+     */
+    static bool save(QStringView dbFolder, QStringView dataUuid, const QByteArray &data, QString *errorString = nullptr);
+
+    /**
+     * Moves blobs from the old data/<item uuid>/<data uuid> layout into the store.
+     * Safe to call from any thread.
+     */
+    static void migrateLegacyLayout(QStringView dbFolder);
+
+    /**
+     * Deletes every blob, and its thumbnails, that isn't in @p referencedUuids and
+     * wasn't written or reused after @p startTime. Safe to call from any thread.
+     *
+     * @return the number of bytes reclaimed
+     */
+    static qint64 compact(QStringView dbFolder, const QSet<QString> &referencedUuids, const QDateTime &startTime);
+};
@@ -91,6 +91,15 @@ GeneralWidget::GeneralWidget(QWidget *parent)
     KLocalization::setupSpinBoxFormatString(m_historySizeSb, ki18ncp("Number of entries", "%v entry", "%v entries"));
     layout->addRow(item->label(), m_historySizeSb);
 
+    // Clipboard history size in bytes
+    item = KlipperSettings::self()->maxHistorySizeItem();
+    m_historyBytesSb = new QSpinBox(this);
+    m_historyBytesSb->setObjectName(QLatin1String("kcfg_MaxHistorySize"));
+    KLocalization::setupSpinBoxFormatString(m_historyBytesSb, ki18nc("@item:valuesuffix size in megabytes", "%v MiB"));
+    m_historyBytesSb->setSpecialValueText(i18nc("@item:inlistbox no limit for the history size", "No limit"));
+    m_historyBytesSb->setToolTip(item->toolTip());
+    layout->addRow(item->label(), m_historyBytesSb);
+
     layout->addRow(QString(), new QLabel(this));
 
     // Synchronise selection and clipboard
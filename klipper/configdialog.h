@@ -52,6 +52,7 @@ private:
     QRadioButton *m_neverImageRb;
 
     QSpinBox *m_historySizeSb;
+    QSpinBox *m_historyBytesSb;
 
     bool m_havePrevAlwaysImageTextConfig;
     bool m_prevAlwaysImage;
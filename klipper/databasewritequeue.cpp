@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "databasewritequeue.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "klipper_debug.h"
+
+DatabaseWriteQueue::DatabaseWriteQueue(QObject *parent)
+    : QObject(parent)
+{
+    // Not restarted by later statements, so nothing stays in the queue longer than s_maxDelay
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(s_maxDelay);
+    connect(&m_timer, &QTimer::timeout, this, &DatabaseWriteQueue::flush);
+}
+
+DatabaseWriteQueue::~DatabaseWriteQueue()
+{
+    flush();
+}
+
+QSqlDatabase DatabaseWriteQueue::database() const
+{
+    return m_db;
+}
+
+void DatabaseWriteQueue::setDatabase(const QSqlDatabase &database)
+{
+    flush();
+    m_db = database;
+}
+
+void DatabaseWriteQueue::enqueue(const QString &statement, const QVariantList &values, const QString &coalesceKey)
+{
+    if (!coalesceKey.isEmpty()) {
+        // Appending the new statement instead of updating the old one in place keeps the order of the writes
+        std::erase_if(m_statements, [&coalesceKey](const Statement &queued) {
+            return queued.coalesceKey == coalesceKey;
+        });
+    }
+    m_statements.push_back(Statement{statement, values, coalesceKey});
+
+    if (size() >= s_maxQueued) {
+        flush();
+    } else if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+bool DatabaseWriteQueue::flush()
+{
+    m_timer.stop();
+    if (m_statements.empty()) {
+        return true;
+    }
+    const std::vector<Statement> statements = std::exchange(m_statements, {});
+    if (!m_db.isOpen()) [[unlikely]] {
+        qCWarning(KLIPPER_LOG) << "Dropped" << statements.size() << "queued statements, the database is not open";
+        return false;
+    }
+
+    const bool inTransaction = m_db.transaction();
+    if (!inTransaction) {
+        qCWarning(KLIPPER_LOG) << "A transaction didn't start:" << m_db.lastError().text();
+    }
+
+    bool ok = true;
+    {
+        std::unordered_map<QString, QSqlQuery> preparedQueries;
+        for (const Statement &statement : statements) {
+            auto [it, inserted] = preparedQueries.try_emplace(statement.sql, m_db);
+            QSqlQuery &query = it->second;
+            if (inserted && !query.prepare(statement.sql)) {
+                qCWarning(KLIPPER_LOG).nospace().noquote() << "Query \"" << statement.sql << "\" failed: " << query.lastError().text();
+                ok = false;
+                continue;
+            }
+            for (qsizetype i = 0; i < statement.values.size(); ++i) {
+                query.bindValue(int(i), statement.values[i]);
+            }
+            // A failed statement doesn't undo the others, like when every statement ran on its own
+            if (!query.exec()) {
+                qCWarning(KLIPPER_LOG).nospace().noquote() << "Query \"" << statement.sql << "\" failed: " << query.lastError().text();
+                ok = false;
+            }
+        }
+    }
+
+    if (inTransaction && !m_db.commit()) {
+        qCWarning(KLIPPER_LOG) << "Failed to commit queued statements:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    Q_EMIT flushed();
+    return ok;
+}
+
+qsizetype DatabaseWriteQueue::size() const
+{
+    return qsizetype(m_statements.size());
+}
+
+#include "moc_databasewritequeue.cpp"
@@ -0,0 +1,81 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QTimer>
+#include <QVariantList>
+
+#include "klipper_export.h"
+
+/**
+ * Write-behind queue for the history database.
+ *
+ * A burst of clipboard changes used to run one transaction, and one fsync, per
+ * statement. Queued statements run in the order they were queued, in a single
+ * transaction with every distinct statement prepared once, at most s_maxDelay
+ * after the first of them was queued.
+ *
+ * Call flush() before reading anything that may still be in the queue and
+ * before writing to the database directly.
+ */
+class KLIPPER_EXPORT DatabaseWriteQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr std::chrono::milliseconds s_maxDelay{500};
+    /// Flush right away once this many statements are queued
+    static constexpr qsizetype s_maxQueued = 256;
+
+    explicit DatabaseWriteQueue(QObject *parent = nullptr);
+    ~DatabaseWriteQueue() override;
+
+    QSqlDatabase database() const;
+    /**
+     * Flushes the statements queued for the previous database
+     */
+    void setDatabase(const QSqlDatabase &database);
+
+    /**
+     * Queues @p statement with its positional @p values.
+     *
+     * If @p coalesceKey is not empty, a statement queued earlier with the same key is
+     * dropped, e.g. only the last of several timestamp updates of an item is needed.
+     */
+    void enqueue(const QString &statement, const QVariantList &values, const QString &coalesceKey = QString());
+
+    /**
+     * Runs all queued statements now.
+     *
+     * @return false if any of them failed
+     */
+    bool flush();
+
+    qsizetype size() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted after the queued statements were written to the database
+     */
+    void flushed();
+
+private:
+    struct Statement {
+        QString sql;
+        QVariantList values;
+        QString coalesceKey;
+    };
+
+    QSqlDatabase m_db;
+    std::vector<Statement> m_statements;
+    QTimer m_timer;
+};
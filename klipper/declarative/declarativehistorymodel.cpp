@@ -8,6 +8,8 @@
 #include "historyitem.h"
 #include "historymodel.h"
 
+using namespace std::chrono_literals;
+
 DeclarativeHistoryModel::DeclarativeHistoryModel(QObject *parent)
     : QSortFilterProxyModel(parent)
     , m_model(HistoryModel::self())
@@ -32,6 +34,23 @@ DeclarativeHistoryModel::DeclarativeHistoryModel(QObject *parent)
     });
 
     connect(m_model.get(), &HistoryModel::changed, this, &DeclarativeHistoryModel::currentTextChanged);
+
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(150ms);
+    connect(&m_searchTimer, &QTimer::timeout, this, &DeclarativeHistoryModel::search);
+
+    // New and edited items are matched on their preview until the database has them, then searched again
+    auto scheduleSearch = [this] {
+        if (!m_filterText.isEmpty()) {
+            m_searchTimer.start();
+        }
+    };
+    connect(&m_model->m_writeQueue, &DatabaseWriteQueue::flushed, this, scheduleSearch);
+    connect(m_model.get(), &HistoryModel::dataChanged, this, [scheduleSearch](const QModelIndex &, const QModelIndex &, const QList<int> &roles) {
+        if (roles.empty() || roles.contains(Qt::DisplayRole)) {
+            scheduleSearch();
+        }
+    });
 }
 
 DeclarativeHistoryModel::~DeclarativeHistoryModel()
@@ -68,6 +87,55 @@ void DeclarativeHistoryModel::setStarredOnly(bool value)
     Q_EMIT starredOnlyChanged();
 }
 
+QString DeclarativeHistoryModel::filterText() const
+{
+    return m_filterText;
+}
+
+void DeclarativeHistoryModel::setFilterText(const QString &text)
+{
+    if (m_filterText == text) {
+        return;
+    }
+    m_filterText = text;
+    if (m_filterText.isEmpty()) {
+        m_searchTimer.stop();
+        ++m_searchSerial;
+        applySearchResult(QString(), std::nullopt);
+    } else {
+        m_searchTimer.start();
+    }
+    Q_EMIT filterTextChanged();
+}
+
+void DeclarativeHistoryModel::search()
+{
+    const quint64 serial = ++m_searchSerial;
+    m_model->search(m_filterText).then(this, [this, serial, text = m_filterText](std::optional<HistoryModel::SearchResult> result) {
+        if (serial == m_searchSerial) {
+            applySearchResult(text, std::move(result));
+        }
+    });
+}
+
+void DeclarativeHistoryModel::applySearchResult(const QString &text, std::optional<HistoryModel::SearchResult> &&result)
+{
+    m_searchText = text;
+    m_useSearchIndex = result.has_value();
+    m_searchRanks.clear();
+    m_searchedUuids.clear();
+    if (m_useSearchIndex) {
+        m_searchRanks.reserve(result->uuids.size());
+        for (qsizetype rank = 0; rank < result->uuids.size(); ++rank) {
+            m_searchRanks.insert(result->uuids.at(rank), rank);
+        }
+        m_searchedUuids = std::move(result->searchedUuids);
+    }
+    invalidateRowsFilter();
+    // Ranked results when the database answered the query, history order otherwise
+    sort(m_useSearchIndex ? 0 : -1);
+}
+
 void DeclarativeHistoryModel::moveToTop(const QString &uuid)
 {
     m_model->moveToTop(uuid);
@@ -92,11 +160,34 @@ void DeclarativeHistoryModel::invokeAction(const QString &uuid)
 
 bool DeclarativeHistoryModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
-    if (m_starredOnly) {
-        return m_model->index(sourceRow, 0, sourceParent).data(HistoryModel::StarredRole).toBool();
+    const QModelIndex index = m_model->index(sourceRow, 0, sourceParent);
+    if (m_starredOnly && !index.data(HistoryModel::StarredRole).toBool()) {
+        return false;
     }
 
-    return true;
+    if (m_searchText.isEmpty()) {
+        return true;
+    }
+    if (m_useSearchIndex) {
+        if (const QString uuid = index.data(HistoryModel::UuidRole).toString(); m_searchedUuids.contains(uuid)) {
+            return m_searchRanks.contains(uuid);
+        }
+    }
+    // Not in the database yet, or the database is not available
+    return index.data(Qt::DisplayRole).toString().contains(m_searchText, Qt::CaseInsensitive);
+}
+
+bool DeclarativeHistoryModel::lessThan(const QModelIndex &sourceLeft, const QModelIndex &sourceRight) const
+{
+    if (m_useSearchIndex) {
+        // Items that weren't searched yet are the newest ones, they go first
+        const qsizetype leftRank = m_searchRanks.value(sourceLeft.data(HistoryModel::UuidRole).toString(), -1);
+        const qsizetype rightRank = m_searchRanks.value(sourceRight.data(HistoryModel::UuidRole).toString(), -1);
+        if (leftRank != rightRank) {
+            return leftRank < rightRank;
+        }
+    }
+    return sourceLeft.row() < sourceRight.row();
 }
 
 #include "moc_declarativehistorymodel.cpp"
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <QPropertyNotifier>
+#include <QSet>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 #include <qqmlregistration.h>
 
-class HistoryModel;
+#include "historymodel.h"
 
 /**
  * This class provides a view for history clip items in QML
@@ -27,6 +29,13 @@ class DeclarativeHistoryModel : public QSortFilterProxyModel
 
     Q_PROPERTY(bool starredOnly READ starredOnly WRITE setStarredOnly NOTIFY starredOnlyChanged)
 
+    /**
+     * Only show the items containing this text, best match first.
+     *
+     * This is a case-insensitive substring match, not a regular expression.
+     */
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged)
+
 public:
     explicit DeclarativeHistoryModel(QObject *parent = nullptr);
     ~DeclarativeHistoryModel() override;
@@ -38,6 +47,9 @@ public:
     bool starredOnly() const;
     void setStarredOnly(bool value);
 
+    QString filterText() const;
+    void setFilterText(const QString &text);
+
     Q_INVOKABLE void moveToTop(const QString &uuid);
 
     Q_INVOKABLE void remove(const QString &uuid);
@@ -51,12 +63,32 @@ Q_SIGNALS:
     void starredCountChanged();
     void currentTextChanged();
     void starredOnlyChanged();
+    void filterTextChanged();
 
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &sourceLeft, const QModelIndex &sourceRight) const override;
 
 private:
+    /**
+     * Searches the database for m_filterText on a worker thread, then applies the result
+     */
+    void search();
+    void applySearchResult(const QString &text, std::optional<HistoryModel::SearchResult> &&result);
+
     std::shared_ptr<HistoryModel> m_model;
     bool m_starredOnly = false;
+    QString m_filterText;
+    /// Debounces typing and bursts of new items
+    QTimer m_searchTimer;
+    /// Increased for every search, so only the result of the latest one is applied
+    quint64 m_searchSerial = 0;
+    /// The text the rows are filtered with, m_filterText once the search is done
+    QString m_searchText;
+    /// uuid -> rank of the items matching m_searchText, only used when the database can answer the query
+    QHash<QString, qsizetype> m_searchRanks;
+    /// The items the database searched, the others are matched on their preview until the next search
+    QSet<QString> m_searchedUuids;
+    bool m_useSearchIndex = false;
     QPropertyNotifier m_starredCountNotifier;
 };
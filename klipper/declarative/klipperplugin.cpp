@@ -9,6 +9,7 @@
 #include <QQmlExtensionPlugin>
 
 #include "previewimageprovider.h"
+#include "thumbnailimageprovider.h"
 
 void qml_register_types_org_kde_plasma_private_clipboard();
 
@@ -28,6 +29,7 @@ public:
     void initializeEngine(QQmlEngine *engine, const char * /*uri*/) override
     {
         engine->addImageProvider(QStringLiteral("klipperpreview"), new PreviewImageProvider);
+        engine->addImageProvider(QStringLiteral("klipperthumbnail"), new ThumbnailImageProvider);
     }
 };
 
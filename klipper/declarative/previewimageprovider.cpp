@@ -6,14 +6,37 @@
 
 #include "previewimageprovider.h"
 
+#include <QCache>
+#include <QFileInfo>
 #include <QIcon>
 #include <QImage>
+#include <QMutex>
 
 #include <KFileItem>
 #include <KIO/PreviewJob>
 
 using namespace Qt::StringLiterals;
 
+namespace
+{
+/**
+ * Previews of the url items, so reopening the popup doesn't start a preview job for every url again.
+ * Image responses are created on the image loader thread, hence the mutex.
+ */
+struct PreviewCache {
+    QMutex mutex;
+    QCache<QString, QImage> images{16 * 1024}; // KiB
+};
+Q_GLOBAL_STATIC(PreviewCache, s_previewCache)
+
+QString previewCacheKey(const QUrl &url, const QSize &requestedSize)
+{
+    // The modification time makes sure an edited file gets a new preview
+    const qint64 modified = url.isLocalFile() ? QFileInfo(url.toLocalFile()).lastModified().toMSecsSinceEpoch() : 0;
+    return url.toString() + u'@' + QString::number(requestedSize.width()) + u'x' + QString::number(requestedSize.height()) + u'@' + QString::number(modified);
+}
+}
+
 class AsyncPreviewImageResponse : public QQuickImageResponse
 {
     Q_OBJECT
@@ -41,10 +64,26 @@ AsyncPreviewImageResponse::AsyncPreviewImageResponse(const QString &path, const
         return;
     }
 
+    const QString cacheKey = previewCacheKey(url, requestedSize);
+    {
+        QMutexLocker locker(&s_previewCache->mutex);
+        if (const QImage *preview = s_previewCache->images.object(cacheKey)) {
+            QImage image = *preview;
+            locker.unlock();
+            saveImage(std::move(image));
+            return;
+        }
+    }
+
     KIO::PreviewJob *job = KIO::filePreview(KFileItemList{fileItem}, requestedSize);
     job->setIgnoreMaximumSize(true);
-    connect(job, &KIO::PreviewJob::gotPreview, this, [this](const KFileItem &, const QPixmap &preview) {
-        saveImage(preview.toImage());
+    connect(job, &KIO::PreviewJob::gotPreview, this, [this, cacheKey](const KFileItem &, const QPixmap &preview) {
+        QImage image = preview.toImage();
+        {
+            QMutexLocker locker(&s_previewCache->mutex);
+            s_previewCache->images.insert(cacheKey, new QImage(image), std::max<qsizetype>(image.sizeInBytes() / 1024, 1));
+        }
+        saveImage(std::move(image));
     });
     connect(job, &KIO::PreviewJob::failed, this, saveIcon);
 
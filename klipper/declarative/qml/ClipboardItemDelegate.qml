@@ -69,7 +69,7 @@ PlasmaComponents.ItemDelegate {
     onItemSelected: (menuItem.ListView.view.parent as ClipboardMenu).itemSelected(uuid)
     onRemove: (menuItem.ListView.view.parent as ClipboardMenu).remove(uuid)
     onEdit: (menuItem.ListView.view.parent as ClipboardMenu).edit(model)
-    onBarcode: (menuItem.ListView.view.parent as ClipboardMenu).barcode(model.display)
+    onBarcode: (menuItem.ListView.view.parent as ClipboardMenu).barcode(model.text)
     onTriggerAction: (menuItem.ListView.view.parent as ClipboardMenu).triggerAction(uuid)
 
     Accessible.onPressAction: menuItem.itemSelected()
@@ -17,7 +17,6 @@ import org.kde.plasma.extras 2.0 as PlasmaExtras
 import org.kde.plasma.core as PlasmaCore
 import org.kde.plasma.components 3.0 as PlasmaComponents3
 
-import org.kde.kitemmodels 1.0 as KItemModels
 import org.kde.kirigami 2.20 as Kirigami
 import org.kde.ksvg 1.0 as KSvg
 import org.kde.plasma.private.clipboard 0.1 as Private
@@ -73,6 +72,13 @@ PlasmaComponents3.ScrollView {
         }
     }
 
+    // Filtering happens in the history model, backed by the search index
+    Binding {
+        target: clipboardMenu.model
+        property: "filterText"
+        value: filter.text
+    }
+
     Keys.forwardTo: [clipboardMenu.T.StackView.view.currentItem]
     Keys.onPressed: event => {
         if (clipboardMenu.T.StackView.view.currentItem !== clipboardMenu) {
@@ -375,11 +381,7 @@ PlasmaComponents3.ScrollView {
         // ListView KeyNavigation for when no items have focus
         KeyNavigation.left: tabBar.visible ? tabBar : filter
 
-        model: KItemModels.KSortFilterProxyModel {
-            sourceModel: clipboardMenu.model
-            filterRoleName: "display"
-            filterRegularExpression: RegExp(filter.text, "i")
-        }
+        model: clipboardMenu.model
 
         topMargin: Kirigami.Units.largeSpacing
         bottomMargin: Kirigami.Units.largeSpacing
@@ -59,7 +59,7 @@ ColumnLayout {
             id: textArea
             wrapMode: TextEdit.Wrap
             textFormat: TextEdit.PlainText
-            text: editPage.modelData?.display ?? ""
+            text: editPage.modelData?.text ?? ""
 
             Accessible.name: i18ndc("klipper", "@info:whatsthis", "Text edit area")
             KeyNavigation.up: editPage.dialogItem.KeyNavigation.up
@@ -13,6 +13,9 @@ import org.kde.kirigami 2.20 as Kirigami
 
 ClipboardItemDelegate {
     id: menuItem
+
+    required property url thumbnail
+
     mainItem: Item {
         implicitHeight: childrenRect.height
 
@@ -20,7 +23,7 @@ ClipboardItemDelegate {
         Drag.dragType: Drag.Automatic
         Drag.supportedActions: Qt.CopyAction
         Drag.mimeData: {
-            "text/uri-list": [previewImage.source],
+            "text/uri-list": [menuItem.decoration],
         }
 
         Image {
@@ -33,8 +36,8 @@ ClipboardItemDelegate {
             // right in RTL
             anchors.left: parent.left
 
-            cache: false
-            source: menuItem.decoration
+            // Decoded from a small thumbnail instead of the full image
+            source: menuItem.thumbnail
             sourceSize.height: Math.min(menuItem.imageSize.height, Kirigami.Units.gridUnit * 4 + Kirigami.Units.smallSpacing * 2)
             smooth: true
             fillMode: Image.PreserveAspectFit
@@ -53,9 +53,10 @@ ClipboardItemDelegate {
         Drag.active: menuItem.dragHandler.active
         Drag.dragType: Drag.Automatic
         Drag.supportedActions: Qt.CopyAction
-        Drag.mimeData: {
-            "text/plain": menuItem.model?.display ?? "",
-        }
+        // display only has the beginning of the text, read the whole text once a drag starts
+        Drag.mimeData: menuItem.dragHandler.active ? {
+            "text/plain": menuItem.model?.text ?? "",
+        } : {}
     }
 }
 
@@ -23,9 +23,9 @@ ClipboardItemDelegate {
         Drag.active: menuItem.dragHandler.active
         Drag.dragType: Drag.Automatic
         Drag.supportedActions: Qt.CopyAction
-        Drag.mimeData: {
-            "text/uri-list": menuItem.model?.display.split(" ") ?? [],
-        }
+        Drag.mimeData: menuItem.dragHandler.active ? {
+            "text/uri-list": menuItem.model?.text.split(" ") ?? [],
+        } : {}
 
         ListView {
             id: previewList
@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "thumbnailimageprovider.h"
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QtConcurrentRun>
+
+#include "historymodel.h"
+#include "thumbnailcache.h"
+
+class AsyncThumbnailImageResponse : public QQuickImageResponse
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncThumbnailImageResponse(const QString &dataUuid, const QSize &requestedSize);
+
+    QQuickTextureFactory *textureFactory() const override;
+    void cancel() override;
+
+private:
+    QFutureWatcher<QImage> m_watcher;
+};
+
+AsyncThumbnailImageResponse::AsyncThumbnailImageResponse(const QString &dataUuid, const QSize &requestedSize)
+{
+    connect(&m_watcher, &QFutureWatcher<QImage>::finished, this, &QQuickImageResponse::finished);
+    m_watcher.setFuture(QtConcurrent::run(&ThumbnailCache::load, HistoryModel::databaseFolder(), dataUuid, requestedSize));
+}
+
+QQuickTextureFactory *AsyncThumbnailImageResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_watcher.isCanceled() ? QImage() : m_watcher.result());
+}
+
+void AsyncThumbnailImageResponse::cancel()
+{
+    // Only skips the work if it hasn't started yet
+    m_watcher.cancel();
+}
+
+ThumbnailImageProvider::ThumbnailImageProvider()
+{
+}
+
+QQuickImageResponse *ThumbnailImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    return new AsyncThumbnailImageResponse(id, requestedSize);
+}
+
+#include "thumbnailimageprovider.moc"
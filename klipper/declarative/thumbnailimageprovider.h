@@ -0,0 +1,20 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QQuickAsyncImageProvider>
+
+/**
+ * Serves image://klipperthumbnail/<data uuid> from the ThumbnailCache, decoding on the global thread pool
+ */
+class ThumbnailImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    explicit ThumbnailImageProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+};
@@ -9,12 +9,15 @@
 #include <QSqlQuery>
 
 #include "historymodel.h"
+#include "historytextcache.h"
 
 using namespace Qt::StringLiterals;
 
 HistoryItem::HistoryItem(const QString &uuid, const QStringList &mimeTypes, const QString &text)
     : m_uuid(uuid)
     , m_text(text)
+    , m_preview(text.left(s_previewLength))
+    , m_hasText(!text.isEmpty())
 {
     if (std::any_of(mimeTypes.cbegin(), mimeTypes.cend(), [](const QString &mimeType) {
             return mimeType.startsWith(u"text/");
@@ -39,7 +42,7 @@ HistoryItemType HistoryItem::type() const
 {
     if (m_types & HistoryItemType::Url) {
         return HistoryItemType::Url;
-    } else if ((m_types & HistoryItemType::Text) && !m_text.isEmpty()) {
+    } else if ((m_types & HistoryItemType::Text) && m_hasText) {
         return HistoryItemType::Text;
     } else if (m_types & HistoryItemType::Image) {
         return HistoryItemType::Image;
@@ -49,10 +52,25 @@ HistoryItemType HistoryItem::type() const
 
 QString HistoryItem::text() const
 {
+    if (m_text.isEmpty() && m_hasText) {
+        if (std::shared_ptr<HistoryTextCache> textCache = m_textCache.lock()) {
+            return textCache->text(m_uuid);
+        }
+    }
     return m_text;
 }
 
-HistoryItemPtr HistoryItem::create(const QSqlQuery &query)
+void HistoryItem::releaseText(const std::shared_ptr<HistoryTextCache> &textCache)
+{
+    if (m_text.isEmpty() || !textCache) {
+        return;
+    }
+    textCache->insert(m_uuid, m_text);
+    m_textCache = textCache;
+    m_text.clear();
+}
+
+HistoryItemPtr HistoryItem::create(const QSqlQuery &query, const std::shared_ptr<HistoryTextCache> &textCache)
 {
     QString uuid = query.value(u"uuid"_s).toString();
     if (uuid.isEmpty()) {
@@ -62,6 +80,13 @@ HistoryItemPtr HistoryItem::create(const QSqlQuery &query)
     if (mimeTypes.empty()) {
         return HistoryItemPtr();
     }
+    if (textCache) {
+        auto item = std::make_shared<HistoryItem>(std::move(uuid), std::move(mimeTypes), QString());
+        item->m_hasText = query.value(u"has_text"_s).toBool();
+        item->m_preview = query.value(u"preview"_s).toString();
+        item->m_textCache = textCache;
+        return item;
+    }
     QString text = query.value(u"text"_s).toString();
 
     return std::make_shared<HistoryItem>(std::move(uuid), std::move(mimeTypes), std::move(text));
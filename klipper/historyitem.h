@@ -18,6 +18,7 @@ class QDataStream;
 class QSqlQuery;
 
 class HistoryItem;
+class HistoryTextCache;
 typedef std::shared_ptr<HistoryItem> HistoryItemPtr;
 typedef std::shared_ptr<const HistoryItem> HistoryItemConstPtr;
 
@@ -35,6 +36,9 @@ Q_DECLARE_FLAGS(HistoryItemTypes, HistoryItemType);
 class KLIPPER_EXPORT HistoryItem
 {
 public:
+    /// The number of characters of the text that is always kept in memory, see preview()
+    static constexpr qsizetype s_previewLength = 500;
+
     explicit HistoryItem(const QString &uuid, const QStringList &mimeTypes, const QString &text);
     virtual ~HistoryItem();
 
@@ -58,6 +62,29 @@ public:
      */
     QString text() const;
 
+    /**
+     * @return the first s_previewLength characters of text(), for showing the
+     * item without loading its whole text
+     */
+    const QString &preview() const
+    {
+        return m_preview;
+    }
+
+    /**
+     * Drops the text of the item once it's saved, @p textCache takes it over and
+     * text() loads it from the database again after the cache evicted it.
+     */
+    void releaseText(const std::shared_ptr<HistoryTextCache> &textCache);
+
+    /**
+     * @return the number of characters of the text kept in the item itself, not counting the preview
+     */
+    qsizetype residentTextSize() const
+    {
+        return m_text.size();
+    }
+
     /**
      * @return uuid of current item.
      */
@@ -75,14 +102,20 @@ public:
     }
 
     /**
-     * Create an HistoryItem from data stream (i.e., disk file)
-     * returns null if creation fails. In this case, the datastream
-     * is left in an undefined state.
+     * Create an HistoryItem from a row of the main table
+     * returns null if creation fails.
+     *
+     * If @p textCache is set, the row only needs a has_text and a preview column
+     * instead of the text, which is then loaded from @p textCache when it's first needed.
      */
-    static HistoryItemPtr create(const QSqlQuery &query);
+    static HistoryItemPtr create(const QSqlQuery &query, const std::shared_ptr<HistoryTextCache> &textCache = {});
 
 private:
     QString m_uuid;
     HistoryItemTypes m_types = HistoryItemType::Unknown;
     QString m_text;
+    QString m_preview;
+    bool m_hasText = false;
+    /// Set when the text is not kept in the item
+    std::weak_ptr<HistoryTextCache> m_textCache;
 };
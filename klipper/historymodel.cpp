@@ -10,22 +10,27 @@
 #include <chrono>
 #include <zlib.h>
 
+#include <QCoreApplication>
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
+#include <QFutureWatcher>
 #include <QImageReader>
 #include <QMimeData>
-#include <QSaveFile>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QStandardPaths>
+#include <QUuid>
+#include <QtConcurrentRun>
 
-#include <KIO/DeleteJob>
 #include <KLocalizedString>
 #include <KMessageBox>
 
+#include "blobstore.h"
+#include "databasewritequeue.h"
 #include "config-klipper.h"
 #include "historyitem.h"
+#include "historytextcache.h"
 #include "klipper_debug.h"
 #include "klippersettings.h"
 #include "systemclipboard.h"
@@ -81,22 +86,55 @@ struct TransactionGuard {
     bool committed = true;
 };
 
-QString computeUuid(const QMimeData *data)
+// Larger clips are hashed on a worker thread, hashing this much takes well under a millisecond
+constexpr qsizetype s_maxInlineHashSize = 64 * 1024;
+
+QString itemText(const MimeDataSnapshot &snapshot)
 {
-    QCryptographicHash hash(QCryptographicHash::Sha1);
-    if (data->hasText()) {
-        hash.addData(data->text().toUtf8());
+    if (snapshot.urls.empty()) {
+        return snapshot.text;
     }
-    if (data->hasUrls()) {
-        for (const auto urls = data->urls(); const QUrl &url : urls) {
-            hash.addData(url.toEncoded());
-        }
+    QStringList urlText;
+    urlText.reserve(snapshot.urls.size());
+    for (const QUrl &url : snapshot.urls) {
+        urlText.append(url.toString(QUrl::FullyEncoded));
+    }
+    return urlText.join(u' ');
+}
+
+std::optional<HistoryModel::SearchResult> searchDatabase(const QSqlDatabase &db, bool useSearchIndex, const QString &text)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec(u"SELECT uuid FROM main"_s)) {
+        qCWarning(KLIPPER_LOG) << "Failed to search history:" << query.lastError().text();
+        return std::nullopt;
+    }
+    HistoryModel::SearchResult result;
+    while (query.next()) {
+        result.searchedUuids.insert(query.value(0).toString());
     }
-    if (data->hasImage()) {
-        const QImage image = data->imageData().value<QImage>();
-        hash.addData(QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()));
+
+    // A trigram needs at least three characters, shorter queries would match nothing in the index
+    if (useSearchIndex && text.size() >= 3) {
+        query.prepare(u"SELECT main.uuid FROM search JOIN main ON main.rowid = search.rowid WHERE search MATCH ? ORDER BY search.rank"_s);
+        // Quoted as a single string so the query is matched as a substring instead of being parsed as FTS5 syntax
+        query.addBindValue(u'"' + QString(text).replace(u'"', u"\"\""_s) + u'"');
+    } else {
+        // Still cheaper than loading the text of every item into memory
+        query.prepare(u"SELECT uuid FROM main WHERE text LIKE ? ESCAPE '\\' ORDER BY last_used_time DESC, added_time DESC"_s);
+        QString pattern = text;
+        pattern.replace(u'\\', u"\\\\"_s).replace(u'%', u"\\%"_s).replace(u'_', u"\\_"_s);
+        query.addBindValue(u'%' + pattern + u'%');
+    }
+    if (!query.exec()) {
+        qCWarning(KLIPPER_LOG) << "Failed to search history:" << query.lastError().text();
+        return std::nullopt;
+    }
+    while (query.next()) {
+        result.uuids.append(query.value(0).toString());
     }
-    return QString::fromLatin1(hash.result().toHex());
+    return result;
 }
 }
 
@@ -146,6 +184,7 @@ HistoryModel::HistoryModel()
     connect(this, &HistoryModel::modelReset, this, [this] {
         Q_EMIT changed(true);
     });
+    connect(&m_writeQueue, &DatabaseWriteQueue::flushed, this, &HistoryModel::releaseSavedTexts);
 
     connect(this, &HistoryModel::changed, this, [this](bool isTop) {
         if (m_items.empty()) {
@@ -155,24 +194,38 @@ HistoryModel::HistoryModel()
         if (!isTop) {
             return;
         }
+        if (m_records.value(m_items[0]->uuid()).pending) {
+            // Not in the database yet, this runs again once the data is saved
+            return;
+        }
 
-        QSqlQuery query(m_db);
-        query.prepare(u"UPDATE main SET last_used_time=? WHERE uuid='%1'"_s.arg(m_items[0]->uuid()));
-        query.addBindValue(QDateTime::currentMSecsSinceEpoch() / 1000.0);
-        if (query.exec()) {
-            if (m_clip->isLocked(QClipboard::Selection) || m_clip->isLocked(QClipboard::Clipboard)) {
-                return;
-            }
-            m_clip->setMimeData(m_items[0], SystemClipboard::SelectionMode(SystemClipboard::Clipboard | SystemClipboard::Selection));
+        // Only the latest timestamp of an item matters, so a burst of changes writes it once
+        const QString &uuid = m_items[0]->uuid();
+        m_writeQueue.enqueue(u"UPDATE main SET last_used_time=? WHERE uuid=?"_s, {QDateTime::currentMSecsSinceEpoch() / 1000.0, uuid}, u"last_used_time:" + uuid);
+        if (m_clip->isLocked(QClipboard::Selection) || m_clip->isLocked(QClipboard::Clipboard)) {
+            return;
         }
+        m_clip->setMimeData(m_items[0], SystemClipboard::SelectionMode(SystemClipboard::Clipboard | SystemClipboard::Selection));
     });
 
+    // The model may outlive the event loop, don't lose the last changes
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, [this] {
+            m_writeQueue.flush();
+        });
+    }
+
+    m_compactionTimer.setSingleShot(true);
+    m_compactionTimer.setInterval(5s);
+    connect(&m_compactionTimer, &QTimer::timeout, this, &HistoryModel::compactBlobs);
+
     connect(m_clip.get(), &SystemClipboard::ignored, this, &HistoryModel::slotIgnored);
     connect(m_clip.get(), &SystemClipboard::newClipData, this, &HistoryModel::checkClipData);
 }
 
 HistoryModel::~HistoryModel()
 {
+    m_writeQueue.flush();
     if (!m_bKeepContents) {
         m_db.close();
         QFile(m_db.databaseName()).remove();
@@ -185,23 +238,21 @@ void HistoryModel::clear()
     if (!m_db.isOpen()) {
         return;
     }
+    m_writeQueue.flush();
     if (TransactionGuard transaction(&m_db); !transaction.exec(u"DELETE FROM main"_s) || !transaction.exec(u"DELETE FROM aux"_s)) {
         return;
     }
-    QList<QUrl> deletedDataFolders;
-    deletedDataFolders.reserve(m_items.size());
-    std::transform(m_items.cbegin(), m_items.cend(), std::back_inserter(deletedDataFolders), [this](const auto &item) {
-        return QUrl::fromLocalFile(m_dbFolder + u"/data/" + item->uuid() + u'/');
-    });
-    auto job = KIO::del(deletedDataFolders, KIO::HideProgressInfo);
-    ++m_pendingJobs;
-    connect(job, &KJob::finished, this, [this] {
-        --m_pendingJobs;
-    });
-    QSqlQuery(u"VACUUM"_s, m_db).exec();
+    m_compactionTimer.start(); // Every blob is unreferenced now
+    vacuum();
+    if (m_textCache) {
+        m_textCache->clear();
+    }
     if (!m_items.empty()) { // Is empty when m_bKeepContents is false
         beginResetModel();
         m_items.clear();
+        m_records.clear();
+        m_rowOffset = 0;
+        m_dataBytes = 0;
         m_starredCount = 0;
         endResetModel();
     }
@@ -212,6 +263,7 @@ void HistoryModel::clearNonStarredHistory()
     if (!m_db.isOpen()) {
         return;
     }
+    m_writeQueue.flush();
 
     // Get UUIDs of all non-starred items
     QStringList nonStarredUuids;
@@ -242,29 +294,21 @@ void HistoryModel::clearNonStarredHistory()
         }
     }
 
-    // Delete associated data folders
-    QList<QUrl> deletedDataFolders;
-    deletedDataFolders.reserve(nonStarredUuids.size());
-    for (const QString &uuid : std::as_const(nonStarredUuids)) {
-        deletedDataFolders.append(QUrl::fromLocalFile(m_dbFolder + u"/data/" + uuid + u'/'));
-    }
-    auto job = KIO::del(deletedDataFolders, KIO::HideProgressInfo);
-    ++m_pendingJobs;
-    connect(job, &KJob::finished, this, [this] {
-        --m_pendingJobs;
-    });
+    // Reclaim the data only referenced by the deleted items
+    m_compactionTimer.start();
 
     // Remove items from the model that were deleted
     // We need to work backwards to maintain correct indices
     for (qsizetype i = m_items.size() - 1; i >= 0; --i) {
         if (nonStarredUuids.contains(m_items[i]->uuid())) {
             beginRemoveRows(QModelIndex(), i, i);
+            recordsAboutToBeRemoved(i, 1);
             m_items.removeAt(i);
             endRemoveRows();
         }
     }
 
-    QSqlQuery(u"VACUUM"_s, m_db).exec();
+    vacuum();
 }
 
 void HistoryModel::clearHistory()
@@ -330,16 +374,7 @@ void HistoryModel::setMaxSize(qsizetype size)
         qsizetype removedCount = 0;
 
         for (qsizetype i = m_items.size() - 1; i >= 0 && removedCount < itemsToRemove; --i) {
-            // Check if item is starred
-            QSqlQuery query(m_db);
-            query.prepare(u"SELECT starred FROM main WHERE uuid = ?"_s);
-            query.addBindValue(m_items[i]->uuid());
-            bool isStarred = false;
-            if (query.exec() && query.isSelect() && query.next()) {
-                isStarred = query.value(0).toBool();
-            }
-
-            if (!isStarred) {
+            if (!isItemStarred(m_items[i]->uuid())) {
                 removeRow(i);
                 removedCount++;
                 // Note: After removeRow, indices shift, but since we're going backwards
@@ -351,6 +386,37 @@ void HistoryModel::setMaxSize(qsizetype size)
     }
 }
 
+qint64 HistoryModel::maxBytes() const
+{
+    return m_maxBytes;
+}
+
+void HistoryModel::setMaxBytes(qint64 bytes)
+{
+    if (m_maxBytes == bytes) {
+        return;
+    }
+    m_maxBytes = bytes;
+    trimToBudget();
+}
+
+HistoryModel::Stats HistoryModel::stats() const
+{
+    Stats stats{
+        .items = m_items.size(),
+        .starredItems = m_starredCount.value(),
+        .dataBytes = m_dataBytes,
+        .maxBytes = m_maxBytes,
+        .maxItems = m_maxSize,
+        .cachedTextBytes = m_textCache ? m_textCache->totalCost() * qint64(sizeof(QChar)) : 0,
+        .queuedWrites = m_writeQueue.size(),
+    };
+    for (const auto &item : m_items) {
+        stats.residentTextBytes += item->residentTextSize() * qint64(sizeof(QChar));
+    }
+    return stats;
+}
+
 int HistoryModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid()) {
@@ -370,39 +436,31 @@ QVariant HistoryModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
-    Q_ASSERT_X(m_db.isOpen(), Q_FUNC_INFO, qPrintable(m_db.lastError().text()));
     const std::shared_ptr<HistoryItem> &item = m_items.at(index.row());
+    const ItemRecord record = m_records.value(item->uuid());
 
     switch (role) {
     case Qt::DisplayRole: {
-        if (item->type() == HistoryItemType::Image) {
-            QSqlQuery query(u"SELECT data_uuid FROM aux WHERE uuid='%1' AND (mimetype='%2')"_s.arg(item->uuid(), s_imageFormat), m_db);
-            if (query.exec() && query.isSelect() && query.next()) {
-                QSize size = QImageReader(QString(m_dbFolder + u"/data/" + item->uuid() + u'/' + query.value(0).toString())).size();
-                return QString(u"▨ " + i18nc("@info:tooltip width x height", "%1x%2", QString::number(size.width()), QString::number(size.height())));
-            }
+        if (item->type() == HistoryItemType::Image && record.imageSize.isValid()) {
+            const QSize &size = record.imageSize;
+            return QString(u"▨ " + i18nc("@info:tooltip width x height", "%1x%2", QString::number(size.width()), QString::number(size.height())));
         }
-        return item->text();
+        // Only the preview is in memory, the whole text is read from the database when something asks for it
+        return item->preview();
     }
+    case TextRole:
+        return item->text();
     case ImageUrlRole: {
-        if (!(item->allTypes() & HistoryItemType::Image)) {
+        if (!(item->allTypes() & HistoryItemType::Image) || record.imageDataUuid.isEmpty()) {
             return QUrl();
         }
-        QSqlQuery query(u"SELECT data_uuid FROM aux WHERE uuid='%1' AND (mimetype='%2')"_s.arg(item->uuid(), s_imageFormat), m_db);
-        if (query.exec() && query.isSelect() && query.next()) {
-            return QUrl::fromLocalFile(m_dbFolder + u"/data/" + item->uuid() + u'/' + query.value(0).toString());
-        }
-        return QUrl();
+        return QUrl::fromLocalFile(BlobStore::path(m_dbFolder, record.imageDataUuid));
     }
     case ImageSizeRole: {
         if (!(item->allTypes() & HistoryItemType::Image)) {
             return QSize();
         }
-        QSqlQuery query(u"SELECT data_uuid FROM aux WHERE uuid='%1' AND (mimetype='%2')"_s.arg(item->uuid(), s_imageFormat), m_db);
-        if (query.exec() && query.isSelect() && query.next()) {
-            return QImageReader(m_dbFolder + u"/data/" + item->uuid() + u'/' + query.value(0).toString()).size();
-        }
-        return QSize();
+        return record.imageSize;
     }
     case HistoryItemConstPtrRole:
         return QVariant::fromValue<HistoryItemConstPtr>(std::const_pointer_cast<const HistoryItem>(item));
@@ -413,9 +471,13 @@ QVariant HistoryModel::data(const QModelIndex &index, int role) const
     case TypeIntRole:
         return int(item->type());
     case StarredRole:
-        // TODO: Consider adding QHash<QString, bool> cache for starred status to avoid
-        // frequent database queries if performance becomes an issue with large histories
-        return isItemStarred(item->uuid());
+        return record.starred;
+    case ThumbnailUrlRole: {
+        if (!(item->allTypes() & HistoryItemType::Image) || record.imageDataUuid.isEmpty()) {
+            return QUrl();
+        }
+        return QUrl(u"image://klipperthumbnail/" + record.imageDataUuid);
+    }
     }
     return QVariant();
 }
@@ -426,6 +488,9 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
     if (!checkIndex(index, CheckIndexOption::IndexIsValid)) {
         return false;
     }
+    if (m_records.value(m_items[index.row()]->uuid()).pending) {
+        return false;
+    }
 
     switch (auto &item = m_items[index.row()]; role) {
     case Qt::DisplayRole: {
@@ -438,6 +503,7 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
         }
         QStringList mimetypes{u"text/plain"_s, u"text/plain;charset=utf-8"_s};
         QString newUuid = QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex());
+        m_writeQueue.flush(); // The item may not be in the database yet
         {
             TransactionGuard transaction(&m_db);
             {
@@ -464,8 +530,18 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
             }
         }
 
-        KIO::del(QUrl::fromLocalFile(m_dbFolder + u"/data/" + item->uuid() + u'/'), KIO::HideProgressInfo);
-        saveToFile(m_dbFolder, text.toUtf8(), newUuid, newUuid); // Must be synchronous so the clipboard can be updated immediately
+        // Must be synchronous so the clipboard can be updated immediately
+        const QByteArray data = text.toUtf8();
+        BlobStore::save(m_dbFolder, newUuid, data);
+        m_compactionTimer.start(); // The old text may not be referenced anymore
+
+        // The starred flag survives the edit, the image data doesn't
+        ItemRecord record = m_records.take(item->uuid());
+        record.imageDataUuid.clear();
+        record.imageSize = QSize();
+        m_dataBytes += data.size() - record.dataBytes;
+        record.dataBytes = data.size();
+        m_records.insert(newUuid, std::move(record));
 
         item = std::make_shared<HistoryItem>(std::move(newUuid), std::move(mimetypes), std::move(text));
         Q_EMIT dataChanged(index, index, {Qt::DisplayRole, UuidRole});
@@ -477,21 +553,12 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
             return false;
         }
 
-        QSqlQuery query(m_db);
-        // Use prepared statement for safety
-        query.prepare(u"UPDATE main SET starred = ? WHERE uuid = ?"_s);
-        query.addBindValue(newValue);
-        query.addBindValue(item->uuid());
-
-        if (query.exec()) {
-            // Notify views that this specific role has changed for the item
-            m_starredCount = m_starredCount + (newValue ? 1 : -1);
-            Q_EMIT dataChanged(index, index, {StarredRole});
-            return true;
-        }
-        // TODO: Add user feedback/notification when starring/unstarring fails
-        // Currently users have no indication if the star operation was unsuccessful
-        break;
+        m_writeQueue.enqueue(u"UPDATE main SET starred = ? WHERE uuid = ?"_s, {newValue, item->uuid()}, u"starred:" + item->uuid());
+        m_records[item->uuid()].starred = newValue;
+        // Notify views that this specific role has changed for the item
+        m_starredCount = m_starredCount + (newValue ? 1 : -1);
+        Q_EMIT dataChanged(index, index, {StarredRole});
+        return true;
     }
     }
 
@@ -513,33 +580,17 @@ bool HistoryModel::removeRows(int row, int count, const QModelIndex &parent)
                                     return isItemStarred(item->uuid()) ? (count + 1) : count;
                                 });
 
-    {
-        TransactionGuard transaction(&m_db);
-        QStringList uuidList;
-        for (int i = 0; i < count; ++i) {
-            uuidList.append(u'\'' + m_items[row + i]->uuid() + u'\'');
-        }
-        const QString uuids = uuidList.join(u',');
-        if (!transaction.exec(u"DELETE FROM main WHERE uuid IN (%1)"_s.arg(uuids))) {
-            return false;
-        }
-        if (!transaction.exec(u"DELETE FROM aux WHERE uuid IN (%1)"_s.arg(uuids))) {
-            return false;
-        }
+    // Trimming the history removes one row per clipboard change, let the queue batch them
+    for (int i = row; i < row + count; ++i) {
+        m_writeQueue.enqueue(u"DELETE FROM main WHERE uuid=?"_s, {m_items[i]->uuid()});
+        m_writeQueue.enqueue(u"DELETE FROM aux WHERE uuid=?"_s, {m_items[i]->uuid()});
     }
 
-    QList<QUrl> deletedDataFolders;
-    deletedDataFolders.reserve(count);
-    for (int i = 0; i < count; ++i) {
-        deletedDataFolders.append(QUrl::fromLocalFile(m_dbFolder + u"/data/" + m_items[row + i]->uuid() + u'/'));
-    }
-    auto job = KIO::del(deletedDataFolders, KIO::HideProgressInfo);
-    ++m_pendingJobs;
-    connect(job, &KJob::finished, this, [this] {
-        --m_pendingJobs;
-    });
+    // The data may still be shared with other items, so only drop the references for now
+    m_compactionTimer.start();
 
     beginRemoveRows(QModelIndex(), row, row + count - 1);
+    recordsAboutToBeRemoved(row, count);
     m_items.erase(first, last);
     m_starredCount = newStarredCount;
     endRemoveRows();
@@ -574,10 +625,8 @@ bool HistoryModel::remove(const QString &uuid)
 
 int HistoryModel::indexOf(const QString &uuid) const
 {
-    auto it = std::find_if(m_items.cbegin(), m_items.cend(), [&uuid](const auto &item) {
-        return item->uuid() == uuid;
-    });
-    return it == m_items.cend() ? -1 : std::distance(m_items.cbegin(), it);
+    auto it = m_records.constFind(uuid);
+    return it == m_records.cend() ? -1 : int(it->position - m_rowOffset);
 }
 
 int HistoryModel::indexOf(const HistoryItem *item) const
@@ -602,7 +651,22 @@ bool HistoryModel::insert(const QMimeData *mimeData, qreal timestamp)
         // special case - cannot insert any items
         return false;
     }
-    QString uuid = computeUuid(mimeData);
+
+    QStringList formats = mimeData->formats();
+    if (formats.empty() || formats.size() > 50) [[unlikely]] {
+        return false;
+    }
+
+    // The clipboard data is only read once, everything after this works on the snapshot
+    MimeDataSnapshot snapshot = MimeDataSnapshot::fromMimeData(mimeData);
+    if (snapshot.hashedSize() > s_maxInlineHashSize) {
+        // Hashing a large screenshot or a long text takes long enough to freeze the shell
+        insertPending(std::move(snapshot), std::move(formats), timestamp);
+        return true;
+    }
+
+    snapshot.computeUuid();
+    const QString &uuid = snapshot.uuid;
     if (uuid.size() != 40 /*SHA1*/) [[unlikely]] {
         return false;
     }
@@ -612,54 +676,118 @@ bool HistoryModel::insert(const QMimeData *mimeData, qreal timestamp)
         return true;
     }
 
-    QStringList formats = mimeData->formats();
-    if (formats.empty() || formats.size() > 50) [[unlikely]] {
-        return false;
-    }
+    const QString text = itemText(snapshot);
+    beginInsertRows(QModelIndex(), 0, 0);
+    prependRecord(uuid, ItemRecord{.imageSize = snapshot.hasImage ? snapshot.image.size() : QSize()});
+    m_items.prepend(std::make_shared<HistoryItem>(uuid, formats, text));
+    endInsertRows();
 
-    QString text;
-    if (mimeData->hasUrls()) {
-        QStringList urlText;
-        for (const QList<QUrl> urls = mimeData->urls(); const QUrl &url : urls) {
-            urlText.append(url.toString(QUrl::FullyEncoded));
-        }
-        text = urlText.join(u' ');
-    } else {
-        text = mimeData->text();
-    }
+    startUpdateJob(uuid, text, snapshot, timestamp);
 
-    auto item = std::make_shared<HistoryItem>(uuid, formats, text);
-    auto updateJob = UpdateDatabaseJob::updateClipboard(this, &m_db, m_dbFolder, uuid, text, mimeData, timestamp);
-    if (item->type() == HistoryItemType::Image) {
-        connect(updateJob, &KJob::finished, this, [this, uuid](KJob *job) {
-            if (job->error()) {
-                return;
-            }
-            if (int row = indexOf(uuid); row >= 0) {
-                Q_EMIT dataChanged(index(row), index(row), {Qt::DisplayRole, ImageUrlRole, ImageSizeRole});
-            }
-        });
-    }
+    return true;
+}
 
+void HistoryModel::insertPending(MimeDataSnapshot &&snapshot, QStringList &&formats, qreal timestamp)
+{
+    // The row is shown right away under a temporary uuid, and gets its real uuid once the hash is ready
+    const QString pendingUuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    QString text = itemText(snapshot);
     beginInsertRows(QModelIndex(), 0, 0);
-    m_items.prepend(std::move(item));
+    prependRecord(pendingUuid, ItemRecord{.imageSize = snapshot.hasImage ? snapshot.image.size() : QSize(), .pending = true});
+    m_items.prepend(std::make_shared<HistoryItem>(pendingUuid, formats, text));
     endInsertRows();
 
+    auto watcher = new QFutureWatcher<MimeDataSnapshot>(this);
+    ++m_pendingJobs;
+    connect(watcher,
+            &QFutureWatcher<MimeDataSnapshot>::finished,
+            this,
+            [this, watcher, pendingUuid, formats = std::move(formats), text = std::move(text), timestamp] {
+                watcher->deleteLater();
+                --m_pendingJobs;
+
+                const int row = indexOf(pendingUuid);
+                if (row < 0) {
+                    return; // Removed or cleared in the meantime
+                }
+                const MimeDataSnapshot snapshot = watcher->result();
+                const QString &uuid = snapshot.uuid;
+                if (uuid.size() != 40 /*SHA1*/) [[unlikely]] {
+                    dropPendingRow(row);
+                    return;
+                }
+                if (const int existingItemIndex = indexOf(uuid); existingItemIndex >= 0) {
+                    // Move the existing item above the pending row first, so the top item only changes once
+                    moveToTop(existingItemIndex);
+                    dropPendingRow(indexOf(pendingUuid));
+                    return;
+                }
+
+                // The item stays pending until its data is in the database
+                m_records.insert(uuid, m_records.take(pendingUuid));
+                m_items[row] = std::make_shared<HistoryItem>(uuid, formats, text);
+                Q_EMIT dataChanged(index(row), index(row), {UuidRole});
+                startUpdateJob(uuid, text, snapshot, timestamp);
+            });
+    watcher->setFuture(QtConcurrent::run([snapshot = std::move(snapshot)]() mutable {
+        snapshot.computeUuid();
+        return std::move(snapshot);
+    }));
+}
+
+void HistoryModel::releaseSavedTexts()
+{
+    for (const QString &uuid : std::exchange(m_textsToRelease, {})) {
+        if (auto it = m_records.constFind(uuid); it != m_records.cend()) {
+            m_items[it->position - m_rowOffset]->releaseText(m_textCache);
+        }
+    }
+}
+
+void HistoryModel::dropPendingRow(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    recordsAboutToBeRemoved(row, 1);
+    m_items.removeAt(row);
+    endRemoveRows();
+}
+
+void HistoryModel::startUpdateJob(const QString &uuid, const QString &text, const MimeDataSnapshot &snapshot, qreal timestamp)
+{
+    auto updateJob = UpdateDatabaseJob::updateClipboard(this, &m_writeQueue, m_dbFolder, uuid, text, snapshot, timestamp);
+    connect(updateJob, &KJob::finished, this, [this, uuid, hasImage = snapshot.hasImage](KJob *job) {
+        auto it = m_records.find(uuid);
+        if (it == m_records.end()) {
+            return;
+        }
+        const bool wasPending = std::exchange(it->pending, false);
+        if (job->error()) {
+            return;
+        }
+        auto saveJob = static_cast<UpdateDatabaseJob *>(job);
+        const int row = it->position - m_rowOffset;
+        if (hasImage) {
+            it->imageDataUuid = saveJob->dataUuid(s_imageFormat);
+            Q_EMIT dataChanged(index(row), index(row), {Qt::DisplayRole, ImageUrlRole, ImageSizeRole, ThumbnailUrlRole});
+        } else if (wasPending) {
+            // The changed() handler skipped the row while it was pending, dataChanged() above runs it for images
+            Q_EMIT changed(row == 0);
+        }
+        // The text doesn't need to stay in memory once its row is written
+        m_textsToRelease.append(uuid);
+        if (m_writeQueue.size() == 0) {
+            releaseSavedTexts();
+        }
+        setRecordDataBytes(uuid, saveJob->dataSize());
+        trimToBudget();
+    });
+
     // BUG 417590: Remove only after an item is inserted to avoid clearing clipboard
     if (m_items.size() > m_maxSize) {
         // Find the first non-starred item from the end to remove, skipping starred items
         int itemToRemove = -1;
         for (qsizetype i = m_items.size() - 1; i >= 0; --i) {
-            // Check if item is starred
-            QSqlQuery query(m_db);
-            query.prepare(u"SELECT starred FROM main WHERE uuid = ?"_s);
-            query.addBindValue(m_items[i]->uuid());
-            bool isStarred = false;
-            if (query.exec() && query.isSelect() && query.next()) {
-                isStarred = query.value(0).toBool();
-            }
-
-            if (!isStarred) {
+            if (!isItemStarred(m_items[i]->uuid())) {
                 itemToRemove = i;
                 break;
             }
@@ -678,8 +806,6 @@ bool HistoryModel::insert(const QMimeData *mimeData, qreal timestamp)
         --m_pendingJobs;
     });
     updateJob->start();
-
-    return true;
 }
 
 bool HistoryModel::insert(const QString &text)
@@ -689,15 +815,19 @@ bool HistoryModel::insert(const QString &text)
     return insert(data.get());
 }
 
-bool HistoryModel::loadHistory()
+QString HistoryModel::databaseFolder()
 {
-    constexpr const char *failedLoadWarning = "Failed to load history resource. Clipboard history cannot be read.";
     // don't use "appdata", klipper is also a kicker applet
     if (qEnvironmentVariableIsSet("KLIPPER_DATABASE")) {
-        m_dbFolder = QFileInfo(qEnvironmentVariable("KLIPPER_DATABASE")).absoluteDir().absolutePath();
-    } else {
-        m_dbFolder = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + u"/klipper";
+        return QFileInfo(qEnvironmentVariable("KLIPPER_DATABASE")).absoluteDir().absolutePath();
     }
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + u"/klipper";
+}
+
+bool HistoryModel::loadHistory()
+{
+    constexpr const char *failedLoadWarning = "Failed to load history resource. Clipboard history cannot be read.";
+    m_dbFolder = databaseFolder();
     QDir dataDir(m_dbFolder + u"/data");
     dataDir.mkpath(dataDir.absolutePath());
 
@@ -716,6 +846,8 @@ bool HistoryModel::loadHistory()
         qCWarning(KLIPPER_LOG) << failedLoadWarning << m_db.lastError().text();
         return false;
     }
+    m_writeQueue.setDatabase(m_db);
+    m_clip->setWriteQueue(&m_writeQueue);
 
     QSqlQuery query(m_db);
     query.exec(u"PRAGMA journal_mode=WAL"_s);
@@ -724,11 +856,19 @@ bool HistoryModel::loadHistory()
         u"CREATE TABLE IF NOT EXISTS main (uuid char(40) PRIMARY KEY, added_time REAL NOT NULL CHECK (added_time > 0), last_used_time REAL CHECK (last_used_time > 0), mimetypes TEXT NOT NULL, text NTEXT, starred BOOLEAN)"_s);
     // The aux table stores data index
     query.exec(u"CREATE TABLE IF NOT EXISTS aux (uuid char(40) NOT NULL, mimetype TEXT NOT NULL, data_uuid char(40) NOT NULL, PRIMARY KEY (uuid, mimetype))"_s);
+    // Blobs are shared between items, the aux rows referring to a data_uuid are its references
+    query.exec(u"CREATE INDEX IF NOT EXISTS aux_data_uuid ON aux (data_uuid)"_s);
+    createSearchIndex();
     // Save the latest version number
     query.exec(u"CREATE TABLE IF NOT EXISTS version (db_version INT NOT NULL)"_s);
-    constexpr int currentDBVersion = 3;
+    // Version 4 stores the blobs in data/<first two characters>/<data uuid> instead of data/<item uuid>/<data uuid>,
+    // so older versions refuse the database instead of missing every blob.
+    constexpr int legacyLayoutDBVersion = 3;
+    constexpr int currentDBVersion = 4;
+    int dbVersion = currentDBVersion;
     if (query.exec(u"SELECT db_version FROM version"_s) && query.isSelect() && query.next() /* has a record */) {
-        if (query.value(0).toInt() != currentDBVersion) {
+        dbVersion = query.value(0).toInt();
+        if (dbVersion != currentDBVersion && dbVersion != legacyLayoutDBVersion) {
             return false;
         }
     } else if (!query.exec(u"INSERT INTO version (db_version) VALUES (%1)"_s.arg(QString::number(currentDBVersion)))) {
@@ -740,26 +880,55 @@ bool HistoryModel::loadHistory()
         QSqlQuery clearQuery(m_db);
         clearQuery.exec(u"DELETE FROM main"_s);
         clearQuery.exec(u"DELETE FROM aux"_s);
-        clearQuery.exec(u"VACUUM"_s);
+        vacuum();
         if (dataDir.exists()) {
             dataDir.removeRecursively();
             dataDir.mkpath(dataDir.absolutePath());
         }
     }
 
+    auto setCurrentVersion = [this] {
+        m_writeQueue.enqueue(u"UPDATE version SET db_version=?"_s, {currentDBVersion});
+    };
+    if (dbVersion == legacyLayoutDBVersion && !m_bKeepContents) {
+        setCurrentVersion(); // Nothing left to move
+    }
+
+    // Moving the blobs of an old database into the store can take a while, it's done with the other
+    // file work on a worker thread. Nothing reads the blobs until it's done, see below.
+    QFutureWatcher<void> *migrationWatcher = nullptr;
+    if (dbVersion == legacyLayoutDBVersion && m_bKeepContents) {
+        migrationWatcher = new QFutureWatcher<void>(this);
+        ++m_pendingJobs;
+        connect(migrationWatcher, &QFutureWatcher<void>::finished, this, [this, migrationWatcher, setCurrentVersion] {
+            migrationWatcher->deleteLater();
+            --m_pendingJobs;
+            // Only once every blob is moved, an interrupted migration picks up where it left off
+            setCurrentVersion();
+        });
+        migrationWatcher->setFuture(QtConcurrent::run(&BlobStore::migrateLegacyLayout, m_dbFolder));
+    }
+    m_textCache = std::make_shared<HistoryTextCache>(&m_writeQueue);
+
     if (m_maxSize == 0) {
         return true;
     }
 
     // The last row is either items.size() - 1 or m_maxSize - 1.
     decltype(m_items) items;
+    decltype(m_records) records;
     int starredCount = 0;
-    if (query.exec(u"SELECT * FROM main ORDER BY last_used_time DESC, added_time DESC LIMIT %1"_s.arg(QString::number(m_maxSize))) && query.isSelect()) {
+    // Only read the preview of the text, the rest is loaded when it's first needed so startup doesn't read every text body
+    if (query.exec(u"SELECT uuid, mimetypes, starred, typeof(text) = 'text' AS has_text, substr(text, 1, %1) AS preview FROM main "
+                   u"ORDER BY last_used_time DESC, added_time DESC LIMIT %2"_s.arg(QString::number(HistoryItem::s_previewLength), QString::number(m_maxSize)))
+        && query.isSelect()) {
         items.reserve(std::max(query.size(), 1));
         while (query.next()) {
-            if (HistoryItemPtr item = HistoryItem::create(query)) {
+            if (HistoryItemPtr item = HistoryItem::create(query, m_textCache)) {
+                const bool starred = query.value(u"starred"_s).toBool();
+                records.insert(item->uuid(), ItemRecord{.position = items.size(), .starred = starred});
                 items.emplace_back(std::move(item));
-                starredCount += query.value(u"starred"_s).toBool() ? 1 : 0;
+                starredCount += starred ? 1 : 0;
             }
         }
     }
@@ -771,16 +940,32 @@ bool HistoryModel::loadHistory()
 
     beginResetModel();
     m_items = std::move(items);
+    m_records = std::move(records);
+    m_rowOffset = 0;
+    m_dataBytes = 0;
     m_starredCount = starredCount;
     endResetModel();
 
-    m_clip->setMimeData(m_items[0], SystemClipboard::SelectionMode(SystemClipboard::Clipboard | SystemClipboard::Selection));
+    auto loadBlobs = [this, uuid = m_items[0]->uuid()] {
+        loadImageRecords();
+        loadSizeRecords();
+        // Unless something newer was copied in the meantime
+        if (!m_items.empty() && m_items[0]->uuid() == uuid) {
+            m_clip->setMimeData(m_items[0], SystemClipboard::SelectionMode(SystemClipboard::Clipboard | SystemClipboard::Selection));
+        }
+    };
+    if (migrationWatcher) {
+        connect(migrationWatcher, &QFutureWatcher<void>::finished, this, loadBlobs);
+    } else {
+        loadBlobs();
+    }
 
     return true;
 }
 
 bool HistoryModel::saveClipboardHistory()
 {
+    m_writeQueue.flush();
     QSqlQuery query(u"PRAGMA wal_checkpoint"_s, m_db);
     return query.exec();
 }
@@ -788,6 +973,7 @@ bool HistoryModel::saveClipboardHistory()
 void HistoryModel::loadSettings()
 {
     setMaxSize(KlipperSettings::maxClipItems());
+    setMaxBytes(qint64(KlipperSettings::maxHistorySize()) * 1024 * 1024);
     m_displayImages = !KlipperSettings::ignoreImages();
     m_bNoNullClipboard = KlipperSettings::preventEmptyClipboard();
     // 0 is the id of "Ignore selection" radiobutton
@@ -841,29 +1027,20 @@ void HistoryModel::moveToTop(qsizetype row)
         return;
     }
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), 0);
+    recordAboutToBeMovedToTop(row);
     m_items.move(row, 0);
     endMoveRows();
 }
 
-void HistoryModel::saveToFile(QStringView dbFolder, const QByteArray &data, QStringView newUuid, QStringView dataUuid)
-{
-    const QString folderPath = dbFolder + u"/data/" + newUuid;
-    QDir().mkpath(folderPath);
-    QSaveFile file(folderPath + u'/' + dataUuid);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qCWarning(KLIPPER_LOG) << file.errorString() << folderPath;
-        return;
-    }
-    file.write(data);
-    file.commit();
-}
-
 void HistoryModel::moveTopToBack()
 {
     if (m_items.size() < 2) {
         return;
     }
     beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), m_items.size());
+    // Every other row moves up by one, which is what bumping the offset does
+    ++m_rowOffset;
+    m_records[m_items[0]->uuid()].position = m_rowOffset + m_items.size() - 1;
     auto item = m_items.takeFirst();
     m_items.append(item);
     endMoveRows();
@@ -883,6 +1060,8 @@ QHash<int, QByteArray> HistoryModel::roleNames() const
     hash.insert(UuidRole, QByteArrayLiteral("uuid"));
     hash.insert(TypeIntRole, QByteArrayLiteral("type"));
     hash.insert(StarredRole, QByteArrayLiteral("starred"));
+    hash.insert(ThumbnailUrlRole, QByteArrayLiteral("thumbnail"));
+    hash.insert(TextRole, QByteArrayLiteral("text"));
     return hash;
 }
 
@@ -948,13 +1127,231 @@ void HistoryModel::slotReceivedEmptyClipboard(QClipboard::Mode mode)
 
 bool HistoryModel::isItemStarred(const QString &uuid) const
 {
+    return m_records.value(uuid).starred;
+}
+
+void HistoryModel::prependRecord(const QString &uuid, ItemRecord &&record)
+{
+    // Decrementing the offset moves every existing row down by one
+    record.position = --m_rowOffset;
+    m_dataBytes += record.dataBytes;
+    m_records.insert(uuid, std::move(record));
+}
+
+void HistoryModel::shiftPositions(qsizetype first, qsizetype last, qsizetype delta)
+{
+    for (qsizetype row = first; row < last; ++row) {
+        if (auto it = m_records.find(m_items[row]->uuid()); it != m_records.end()) [[likely]] {
+            it->position += delta;
+        }
+    }
+}
+
+void HistoryModel::recordsAboutToBeRemoved(qsizetype row, qsizetype count)
+{
+    for (qsizetype i = row; i < row + count; ++i) {
+        m_dataBytes -= m_records.take(m_items[i]->uuid()).dataBytes;
+        if (m_textCache) {
+            m_textCache->remove(m_items[i]->uuid());
+        }
+    }
+    // Only touch the shorter side of the removed range, so trimming the tail is constant time
+    if (row < m_items.size() - row - count) {
+        shiftPositions(0, row, count);
+        m_rowOffset += count;
+    } else {
+        shiftPositions(row + count, m_items.size(), -count);
+    }
+}
+
+void HistoryModel::recordAboutToBeMovedToTop(qsizetype row)
+{
+    if (row <= m_items.size() - 1 - row) {
+        shiftPositions(0, row, 1);
+        m_records[m_items[row]->uuid()].position = m_rowOffset;
+    } else {
+        shiftPositions(row + 1, m_items.size(), -1);
+        m_records[m_items[row]->uuid()].position = --m_rowOffset;
+    }
+}
+
+void HistoryModel::compactBlobs()
+{
+    if (m_pendingJobs > 0) {
+        // The data of in-flight inserts may not be referenced in the database yet
+        m_compactionTimer.start();
+        return;
+    }
+
+    const QDateTime startTime = QDateTime::currentDateTimeUtc();
+    m_writeQueue.flush();
     QSqlQuery query(m_db);
-    query.prepare(u"SELECT starred FROM main WHERE uuid = ?"_s);
-    query.addBindValue(uuid);
-    if (query.exec() && query.isSelect() && query.next()) {
-        return query.value(0).toBool();
+    if (!query.exec(u"SELECT DISTINCT data_uuid FROM aux"_s)) {
+        qCWarning(KLIPPER_LOG) << "Failed to collect blob references:" << query.lastError().text();
+        return;
+    }
+    QSet<QString> referencedUuids;
+    while (query.next()) {
+        referencedUuids.insert(query.value(0).toString());
+    }
+
+    auto watcher = new QFutureWatcher<qint64>(this);
+    ++m_pendingJobs;
+    connect(watcher, &QFutureWatcher<qint64>::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        --m_pendingJobs;
+        qCDebug(KLIPPER_LOG) << "Reclaimed" << watcher->result() << "bytes of clip data";
+    });
+    watcher->setFuture(QtConcurrent::run(&BlobStore::compact, m_dbFolder, std::move(referencedUuids), startTime));
+}
+
+void HistoryModel::createSearchIndex()
+{
+    // An external content table: the index refers to the rows of main by rowid instead of storing a second copy of the text.
+    // The triggers keep it in sync with every insert, edit and delete of a history item.
+    QSqlQuery query(m_db);
+    const bool exists = query.exec(u"SELECT 1 FROM sqlite_master WHERE type='table' AND name='search'"_s) && query.next();
+    if (!exists
+        && !query.exec(u"CREATE VIRTUAL TABLE search USING fts5(text, content='main', content_rowid='rowid', tokenize='trigram case_sensitive 0')"_s)) {
+        // SQLite without FTS5 or without the trigram tokenizer (< 3.34), fall back to filtering in memory
+        qCWarning(KLIPPER_LOG) << "Full-text search is not available:" << query.lastError().text();
+        m_searchIndexAvailable = false;
+        return;
+    }
+    query.exec(u"CREATE TRIGGER IF NOT EXISTS search_insert AFTER INSERT ON main BEGIN INSERT INTO search (rowid, text) VALUES (new.rowid, new.text); END"_s);
+    query.exec(
+        u"CREATE TRIGGER IF NOT EXISTS search_delete AFTER DELETE ON main BEGIN INSERT INTO search (search, rowid, text) VALUES ('delete', old.rowid, old.text); END"_s);
+    query.exec(
+        u"CREATE TRIGGER IF NOT EXISTS search_update AFTER UPDATE OF text ON main BEGIN INSERT INTO search (search, rowid, text) VALUES ('delete', old.rowid, old.text); INSERT INTO search (rowid, text) VALUES (new.rowid, new.text); END"_s);
+    if (!exists) {
+        // Index the history saved by an older version
+        query.exec(u"INSERT INTO search (search) VALUES ('rebuild')"_s);
+    }
+    m_searchIndexAvailable = true;
+}
+
+void HistoryModel::vacuum()
+{
+    QSqlQuery query(m_db);
+    query.exec(u"VACUUM"_s);
+    if (m_searchIndexAvailable) {
+        // VACUUM may renumber the rowids of main, which the search index refers to
+        query.exec(u"INSERT INTO search (search) VALUES ('rebuild')"_s);
+    }
+}
+
+QFuture<std::optional<HistoryModel::SearchResult>> HistoryModel::search(const QString &text) const
+{
+    if (!m_db.isOpen()) {
+        return QtFuture::makeReadyValueFuture(std::optional<SearchResult>());
+    }
+    return QtConcurrent::run([databaseName = m_db.databaseName(), useSearchIndex = m_searchIndexAvailable, text] {
+        // A connection can only be used by the thread that opened it
+        const QString connectionName = u"klipper-search-"_s + QUuid::createUuid().toString(QUuid::WithoutBraces);
+        std::optional<SearchResult> result;
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
+            db.setDatabaseName(databaseName);
+            if (db.open()) {
+                result = searchDatabase(db, useSearchIndex, text);
+            } else {
+                qCWarning(KLIPPER_LOG) << "Failed to search history:" << db.lastError().text();
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+        return result;
+    });
+}
+
+void HistoryModel::loadImageRecords()
+{
+    // One query for all image items instead of one per data() call
+    QSqlQuery query(m_db);
+    query.prepare(u"SELECT uuid, data_uuid FROM aux WHERE mimetype=?"_s);
+    query.addBindValue(QString(s_imageFormat));
+    if (!query.exec()) {
+        qCWarning(KLIPPER_LOG) << "Failed to load image records:" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        const QString uuid = query.value(0).toString();
+        if (auto it = m_records.find(uuid); it != m_records.end()) {
+            it->imageDataUuid = query.value(1).toString();
+            it->imageSize = QImageReader(BlobStore::path(m_dbFolder, it->imageDataUuid)).size();
+            const QModelIndex index = this->index(it->position - m_rowOffset);
+            Q_EMIT dataChanged(index, index, {Qt::DisplayRole, ImageUrlRole, ImageSizeRole, ThumbnailUrlRole});
+        }
+    }
+}
+
+void HistoryModel::loadSizeRecords()
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(u"SELECT uuid, data_uuid FROM aux"_s)) {
+        qCWarning(KLIPPER_LOG) << "Failed to load size records:" << query.lastError().text();
+        return;
+    }
+    // Formats of an item often share one blob, count it once per item
+    QHash<QString, QSet<QString>> dataUuidsByItem;
+    while (query.next()) {
+        const QString uuid = query.value(0).toString();
+        if (m_records.contains(uuid)) {
+            dataUuidsByItem[uuid].insert(query.value(1).toString());
+        }
+    }
+
+    using DataBytes = QHash<QString, qint64>;
+    auto watcher = new QFutureWatcher<DataBytes>(this);
+    connect(watcher, &QFutureWatcher<DataBytes>::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        const DataBytes dataBytes = watcher->result();
+        for (auto it = dataBytes.cbegin(); it != dataBytes.cend(); ++it) {
+            setRecordDataBytes(it.key(), it.value());
+        }
+        trimToBudget();
+    });
+    watcher->setFuture(QtConcurrent::run([dbFolder = m_dbFolder, dataUuidsByItem = std::move(dataUuidsByItem)] {
+        // Stat every blob once, no matter how many items refer to it
+        QHash<QString, qint64> blobSizes;
+        DataBytes dataBytes;
+        dataBytes.reserve(dataUuidsByItem.size());
+        for (auto it = dataUuidsByItem.cbegin(); it != dataUuidsByItem.cend(); ++it) {
+            qint64 bytes = 0;
+            for (const QString &dataUuid : it.value()) {
+                auto blobIt = blobSizes.find(dataUuid);
+                if (blobIt == blobSizes.end()) {
+                    blobIt = blobSizes.insert(dataUuid, QFileInfo(BlobStore::path(dbFolder, dataUuid)).size());
+                }
+                bytes += blobIt.value();
+            }
+            dataBytes.insert(it.key(), bytes);
+        }
+        return dataBytes;
+    }));
+}
+
+void HistoryModel::setRecordDataBytes(const QString &uuid, qint64 bytes)
+{
+    auto it = m_records.find(uuid);
+    if (it == m_records.end()) {
+        return; // Removed in the meantime
+    }
+    m_dataBytes += bytes - it->dataBytes;
+    it->dataBytes = bytes;
+}
+
+void HistoryModel::trimToBudget()
+{
+    if (m_maxBytes <= 0) {
+        return;
+    }
+    // Keep the top item even if it's larger than the whole budget, it's the current clipboard content
+    for (qsizetype row = m_items.size() - 1; row > 0 && m_dataBytes > m_maxBytes; --row) {
+        // Items still being saved don't count yet, removing them wouldn't free anything
+        if (const ItemRecord record = m_records.value(m_items[row]->uuid()); !record.starred && record.dataBytes > 0) {
+            removeRow(row);
+        }
     }
-    return false;
 }
 
 #include "moc_historymodel.cpp"
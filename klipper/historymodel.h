@@ -6,18 +6,27 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
 #include <QAbstractListModel>
 #include <QBindable>
 #include <QClipboard>
 #include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QSize>
 #include <QSqlDatabase>
+#include <QTimer>
 
+#include "databasewritequeue.h"
 #include "klipper_export.h"
 
 class KCoreConfigSkeleton;
 class HistoryItem;
+class HistoryTextCache;
 class SystemClipboard;
+struct MimeDataSnapshot;
 class UpdateDatabaseJob;
 
 class KLIPPER_EXPORT HistoryModel : public QAbstractListModel
@@ -31,7 +40,10 @@ public:
         TypeIntRole,
         ImageUrlRole,
         ImageSizeRole,
-        StarredRole
+        StarredRole,
+        ThumbnailUrlRole,
+        /// The whole text of the item, Qt::DisplayRole only has its preview
+        TextRole,
     };
     Q_ENUM(RoleType)
 
@@ -52,6 +64,28 @@ public:
     qsizetype maxSize() const;
     void setMaxSize(qsizetype size);
 
+    /**
+     * The limit for the saved data of the history in bytes, 0 for no limit.
+     * The least recently used items are removed first, starred items are never removed.
+     */
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 bytes);
+
+    struct Stats {
+        qsizetype items = 0;
+        int starredItems = 0;
+        /// The saved data of the items on disk, data shared between items is counted for every item
+        qint64 dataBytes = 0;
+        qint64 maxBytes = 0;
+        qsizetype maxItems = 0;
+        /// The text held by the items in memory
+        qint64 residentTextBytes = 0;
+        /// The text held by the text cache
+        qint64 cachedTextBytes = 0;
+        qsizetype queuedWrites = 0;
+    };
+    Stats stats() const;
+
     /**
      * Clear history
      */
@@ -90,12 +124,38 @@ public:
      * should be reset.
      */
     bool loadHistory();
+
+    /**
+     * @return the folder of the history database and the clip data, safe to call from any thread
+     */
+    static QString databaseFolder();
+    /**
+     * Writes the queued changes to the database and checkpoints it
+     */
     bool saveClipboardHistory();
 
     void loadSettings();
 
     int pendingJobs() const;
 
+    struct SearchResult {
+        /// The uuids of the matching items, best match first
+        QStringList uuids;
+        /// The uuids of all items that were searched, items added later aren't among them
+        QSet<QString> searchedUuids;
+    };
+    /**
+     * Searches the text of the history items in the full-text index, or in the
+     * main table for queries too short for the index.
+     *
+     * The search runs on a worker thread with its own database connection, so it
+     * only sees the items whose rows are already written, the write queue is not flushed.
+     *
+     * @return the result, or std::nullopt if the database is not available and the
+     * caller has to filter the items itself
+     */
+    QFuture<std::optional<SearchResult>> search(const QString &text) const;
+
 Q_SIGNALS:
     void changed(bool isTop = false);
 
@@ -118,7 +178,13 @@ private:
 
     void moveToTop(qsizetype row);
 
-    static void saveToFile(QStringView dbFolder, const QByteArray &data, QStringView newUuid, QStringView dataUuid);
+    void insertPending(MimeDataSnapshot &&snapshot, QStringList &&formats, qreal timestamp);
+    void dropPendingRow(int row);
+    void startUpdateJob(const QString &uuid, const QString &text, const MimeDataSnapshot &snapshot, qreal timestamp);
+    /**
+     * Hands the text of the saved items over to the text cache once their row is written
+     */
+    void releaseSavedTexts();
 
     void clearNonStarredHistory();
 
@@ -129,13 +195,68 @@ private:
      */
     bool isItemStarred(const QString &uuid) const;
 
+    /**
+     * Per-item state kept in memory so data() and indexOf() never have to
+     * query the database or read image headers from disk.
+     */
+    struct ItemRecord {
+        /// The row of the item is position - m_rowOffset
+        qsizetype position = 0;
+        QString imageDataUuid;
+        QSize imageSize;
+        bool starred = false;
+        /// The content hash or the data of the item is still being computed on a worker thread
+        bool pending = false;
+        /// The size of the saved data of the item
+        qint64 dataBytes = 0;
+    };
+
+    void prependRecord(const QString &uuid, ItemRecord &&record);
+    void shiftPositions(qsizetype first, qsizetype last, qsizetype delta);
+    void recordsAboutToBeRemoved(qsizetype row, qsizetype count);
+    void recordAboutToBeMovedToTop(qsizetype row);
+    void loadImageRecords();
+    /**
+     * Reads the size of the saved data of every item on a worker thread, then applies the byte limit
+     */
+    void loadSizeRecords();
+    void setRecordDataBytes(const QString &uuid, qint64 bytes);
+    /**
+     * Removes the least recently used items that aren't starred until the history fits in m_maxBytes
+     */
+    void trimToBudget();
+
+    void createSearchIndex();
+    /**
+     * Shrinks the database file and rebuilds the search index
+     */
+    void vacuum();
+
+    /**
+     * Deletes the blobs that are no longer referenced by any item, on a worker thread
+     */
+    void compactBlobs();
+
     std::shared_ptr<SystemClipboard> m_clip;
     QList<std::shared_ptr<HistoryItem>> m_items;
+    QHash<QString, ItemRecord> m_records;
+    /// The text of the items restored from the database, see HistoryItem::create
+    std::shared_ptr<HistoryTextCache> m_textCache;
+    /// Saved items whose row may still be in m_writeQueue, see releaseSavedTexts()
+    QStringList m_textsToRelease;
+    qsizetype m_rowOffset = 0;
     Q_OBJECT_BINDABLE_PROPERTY_WITH_ARGS(HistoryModel, int, m_starredCount, 0)
     int m_pendingJobs = 0;
+    QTimer m_compactionTimer;
     QString m_dbFolder;
     QSqlDatabase m_db;
+    /// Every write to m_db after loading goes through here, flush it before writing directly
+    DatabaseWriteQueue m_writeQueue;
     qsizetype m_maxSize = 0;
+    qint64 m_maxBytes = 0;
+    /// The sum of ItemRecord::dataBytes
+    qint64 m_dataBytes = 0;
+    bool m_searchIndexAvailable = false;
     bool m_displayImages = false;
     bool m_bNoNullClipboard = true;
     bool m_bIgnoreSelection = true;
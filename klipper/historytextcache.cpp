@@ -0,0 +1,61 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "historytextcache.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "databasewritequeue.h"
+#include "klipper_debug.h"
+
+using namespace Qt::StringLiterals;
+
+HistoryTextCache::HistoryTextCache(DatabaseWriteQueue *writeQueue, qsizetype maxCost)
+    : m_writeQueue(writeQueue)
+    , m_texts(maxCost)
+{
+}
+
+QString HistoryTextCache::text(const QString &uuid)
+{
+    if (const QString *text = m_texts.object(uuid)) {
+        return *text;
+    }
+
+    QSqlQuery query(m_writeQueue->database());
+    query.prepare(u"SELECT text FROM main WHERE uuid=?"_s);
+    query.addBindValue(uuid);
+    if (!query.exec() || !query.next()) {
+        qCWarning(KLIPPER_LOG) << "Failed to load the text of" << uuid << query.lastError().text();
+        return QString();
+    }
+
+    QString text = query.value(0).toString();
+    insert(uuid, text);
+    return text;
+}
+
+void HistoryTextCache::insert(const QString &uuid, const QString &text)
+{
+    // Shares the data with the caller's string, QCache deletes it right away if it's too large
+    m_texts.insert(uuid, new QString(text), std::max<qsizetype>(text.size(), 1));
+}
+
+void HistoryTextCache::remove(const QString &uuid)
+{
+    m_texts.remove(uuid);
+}
+
+void HistoryTextCache::clear()
+{
+    m_texts.clear();
+}
+
+qsizetype HistoryTextCache::totalCost() const
+{
+    return m_texts.totalCost();
+}
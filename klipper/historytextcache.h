@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QCache>
+#include <QString>
+
+#include "klipper_export.h"
+
+class DatabaseWriteQueue;
+
+/**
+ * The text of the history items restored from the database.
+ *
+ * Items loaded at startup only carry their uuid and types, their text is read
+ * from the main table the first time it's needed and kept in a least recently
+ * used cache, so a long history doesn't keep every text body in memory.
+ * The uuid of an item is the hash of its content, so cached texts never go stale.
+ *
+ * Items added in this session hand their text over once it's written to the database,
+ * see HistoryItem::releaseText(), so a text that isn't cached can always be read back
+ * without flushing the write queue.
+ */
+class KLIPPER_EXPORT HistoryTextCache
+{
+public:
+    /// In characters. Texts larger than the whole cache are read from the database every time.
+    static constexpr qsizetype s_defaultMaxCost = 4 * 1024 * 1024;
+
+    /**
+     * @param writeQueue the queue writing the main table, texts that aren't cached are read from its database
+     */
+    explicit HistoryTextCache(DatabaseWriteQueue *writeQueue, qsizetype maxCost = s_defaultMaxCost);
+
+    /**
+     * @return the text of the item @p uuid, or an empty string if it's not in the database
+     */
+    QString text(const QString &uuid);
+
+    void insert(const QString &uuid, const QString &text);
+    void remove(const QString &uuid);
+    void clear();
+
+    /**
+     * @return the number of characters in the cache
+     */
+    qsizetype totalCost() const;
+
+private:
+    DatabaseWriteQueue *m_writeQueue = nullptr;
+    QCache<QString, QString> m_texts;
+};
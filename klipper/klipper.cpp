@@ -389,7 +389,22 @@ QStringList Klipper::getClipboardHistoryMenu()
 
 QString Klipper::getClipboardHistoryItem(int i)
 {
-    return m_historyModel->index(i).data(Qt::DisplayRole).toString();
+    return m_historyModel->index(i).data(HistoryModel::TextRole).toString();
+}
+
+QVariantMap Klipper::getClipboardHistoryStats()
+{
+    const HistoryModel::Stats stats = m_historyModel->stats();
+    return {
+        {QStringLiteral("items"), qlonglong(stats.items)},
+        {QStringLiteral("starredItems"), stats.starredItems},
+        {QStringLiteral("maxItems"), qlonglong(stats.maxItems)},
+        {QStringLiteral("dataBytes"), stats.dataBytes},
+        {QStringLiteral("maxBytes"), stats.maxBytes},
+        {QStringLiteral("residentTextBytes"), stats.residentTextBytes},
+        {QStringLiteral("cachedTextBytes"), stats.cachedTextBytes},
+        {QStringLiteral("queuedWrites"), qlonglong(stats.queuedWrites)},
+    };
 }
 
 void Klipper::updateTimestamp()
@@ -497,21 +512,21 @@ QString Klipper::cycleText() const
         result += QLatin1String("<tr><td>");
         result += i18n("up");
         result += QLatin1String("</td><td>");
-        result += font_metrics.elidedText(itemPrev->text().simplified().toHtmlEscaped(), Qt::ElideMiddle, WIDTH_IN_PIXEL);
+        result += font_metrics.elidedText(itemPrev->preview().simplified().toHtmlEscaped(), Qt::ElideMiddle, WIDTH_IN_PIXEL);
         result += QLatin1String("</td></tr>");
     }
 
     result += QLatin1String("<tr><td>");
     result += i18n("current");
     result += QLatin1String("</td><td><b>");
-    result += font_metrics.elidedText(item->text().simplified().toHtmlEscaped(), Qt::ElideMiddle, WIDTH_IN_PIXEL);
+    result += font_metrics.elidedText(item->preview().simplified().toHtmlEscaped(), Qt::ElideMiddle, WIDTH_IN_PIXEL);
     result += QLatin1String("</b></td></tr>");
 
     if (itemNext) {
         result += QLatin1String("<tr><td>");
         result += i18n("down");
         result += QLatin1String("</td><td>");
-        result += font_metrics.elidedText(itemNext->text().simplified().toHtmlEscaped(), Qt::ElideMiddle, WIDTH_IN_PIXEL);
+        result += font_metrics.elidedText(itemNext->preview().simplified().toHtmlEscaped(), Qt::ElideMiddle, WIDTH_IN_PIXEL);
         result += QLatin1String("</td></tr>");
     }
 
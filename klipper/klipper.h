@@ -61,6 +61,11 @@ public Q_SLOTS:
      */
     Q_SCRIPTABLE void reloadConfig();
 
+    /*
+     * Returns the number of items and the memory and disk usage of the history
+     */
+    Q_SCRIPTABLE QVariantMap getClipboardHistoryStats();
+
 public:
     static std::shared_ptr<Klipper> self();
     Klipper(QObject *parent = nullptr);
@@ -28,7 +28,9 @@
 #include <kurlmimedata.h>
 
 #include "../c_ptr.h"
+#include "blobstore.h"
 #include "config-X11.h"
+#include "databasewritequeue.h"
 #include "historyitem.h"
 #include "klipper_debug.h"
 #include "updateclipboardjob.h"
@@ -133,7 +135,7 @@ void DatabaseRecordToMimeDataJob::start()
         if (mimeType.isEmpty() || dataUuid.isEmpty()) {
             continue;
         }
-        const QString dataPath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + u"/klipper/data/" + m_uuid + u'/' + dataUuid;
+        const QString dataPath = BlobStore::path(QString(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + u"/klipper"), dataUuid);
         auto job = KIO::open(QUrl::fromLocalFile(dataPath), QIODevice::ReadOnly);
         connect(job, &KIO::FileJob::open, this, [this, job, mimeType] {
             connect(job, &KIO::FileJob::data, this, [this, job, mimeType](KJob *, const QByteArray &data) {
@@ -280,6 +282,11 @@ void SystemClipboard::setMimeData(const HistoryItemConstPtr &data, SelectionMode
         return;
     }
 
+    // The rows of a just copied item may still wait in the queue
+    if (m_writeQueue) {
+        m_writeQueue->flush();
+    }
+
     auto job = new DatabaseRecordToMimeDataJob(this, data);
     connect(job, &KJob::finished, this, [this, job, mode, updateReason] {
         setMimeDataInternal(mode & Selection ? job->mimeData() : nullptr, mode & Clipboard ? job->mimeData() : nullptr, updateReason);
@@ -328,6 +335,11 @@ bool SystemClipboard::isLocked(QClipboard::Mode mode)
     return mode == QClipboard::Selection ? m_selectionLocklevel : m_clipboardLocklevel;
 }
 
+void SystemClipboard::setWriteQueue(DatabaseWriteQueue *writeQueue)
+{
+    m_writeQueue = writeQueue;
+}
+
 void SystemClipboard::slotClearOverflow()
 {
     m_overflowClearTimer.stop();
@@ -10,6 +10,7 @@
 
 #include <QClipboard>
 #include <QObject>
+#include <QPointer>
 #include <QTimer>
 
 #include <KSystemClipboard>
@@ -17,6 +18,7 @@
 #include "klipper_export.h"
 
 class KSystemClipboard;
+class DatabaseWriteQueue;
 class HistoryItem;
 
 /**
@@ -92,6 +94,12 @@ public:
 
     bool isLocked(QClipboard::Mode mode);
 
+    /**
+     * The queue of the writes to the history database, flushed before the data of a
+     * history item is read back from the database
+     */
+    void setWriteQueue(DatabaseWriteQueue *writeQueue);
+
 Q_SIGNALS:
     // Only emitted when data is valid
     void newClipData(QClipboard::Mode mode, const QMimeData *data);
@@ -123,4 +131,5 @@ private:
     QTimer m_pendingCheckTimer;
     bool m_pendingContentsCheck = false;
     int m_pendingJobs = 0;
+    QPointer<DatabaseWriteQueue> m_writeQueue;
 };
@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "thumbnailcache.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+
+#include "blobstore.h"
+#include "klipper_debug.h"
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+bool fits(const QSize &size, int bucket)
+{
+    return size.width() <= bucket && size.height() <= bucket;
+}
+
+void save(const QString &filePath, const QImage &thumbnail)
+{
+    if (!QDir().mkpath(QFileInfo(filePath).absolutePath())) [[unlikely]] {
+        qCWarning(KLIPPER_LOG) << "Failed to create the folder for" << filePath;
+        return;
+    }
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || !QImageWriter(&file, "PNG").write(thumbnail) || !file.commit()) {
+        qCWarning(KLIPPER_LOG) << "Failed to save thumbnail" << filePath << file.errorString();
+    }
+}
+
+QImage scaledToFit(QImage &&image, const QSize &requestedSize)
+{
+    // A source size in QML may only set one dimension
+    const int width = requestedSize.width() > 0 ? requestedSize.width() : image.width();
+    const int height = requestedSize.height() > 0 ? requestedSize.height() : image.height();
+    if (image.width() <= width && image.height() <= height) {
+        return std::move(image);
+    }
+    return image.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+}
+
+int ThumbnailCache::bucket(const QSize &requestedSize)
+{
+    const int edge = std::max(requestedSize.width(), requestedSize.height());
+    if (edge <= 0) {
+        return s_buckets.back();
+    }
+    auto it = std::find_if(s_buckets.cbegin(), s_buckets.cend(), [edge](int bucket) {
+        return bucket >= edge;
+    });
+    return it == s_buckets.cend() ? s_buckets.back() : *it;
+}
+
+QString ThumbnailCache::path(QStringView dbFolder, QStringView dataUuid, int bucket)
+{
+    return dbFolder + u"/data/thumbnails/" + QString::number(bucket) + u'/' + dataUuid + u".png";
+}
+
+void ThumbnailCache::generate(QStringView dbFolder, QStringView dataUuid, const QImage &image)
+{
+    if (QFileInfo::exists(path(dbFolder, dataUuid, s_buckets.front()))) {
+        return; // The smallest one is saved last, the same image was copied before
+    }
+    // From the largest to the smallest bucket, so each one is scaled from the previous thumbnail
+    QImage thumbnail = image;
+    for (auto it = s_buckets.crbegin(); it != s_buckets.crend(); ++it) {
+        if (fits(thumbnail.size(), *it)) {
+            continue; // Served by the image itself
+        }
+        thumbnail = thumbnail.scaled(*it, *it, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        save(path(dbFolder, dataUuid, *it), thumbnail);
+    }
+}
+
+QImage ThumbnailCache::load(QStringView dbFolder, QStringView dataUuid, const QSize &requestedSize)
+{
+    const int bucket = ThumbnailCache::bucket(requestedSize);
+    const QString thumbnailPath = path(dbFolder, dataUuid, bucket);
+    if (QImage thumbnail(thumbnailPath, "PNG"); !thumbnail.isNull()) {
+        return scaledToFit(std::move(thumbnail), requestedSize);
+    }
+
+    // Added before the thumbnail cache existed, or small enough to not need a thumbnail
+    QImageReader reader(BlobStore::path(dbFolder, dataUuid), "PNG");
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qCWarning(KLIPPER_LOG) << "Failed to load image" << dataUuid << reader.errorString();
+        return QImage();
+    }
+    if (!fits(image.size(), bucket)) {
+        image = image.scaled(bucket, bucket, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        save(thumbnailPath, image);
+    }
+    return scaledToFit(std::move(image), requestedSize);
+}
@@ -0,0 +1,50 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <array>
+
+#include <QImage>
+#include <QString>
+
+#include "klipper_export.h"
+
+/**
+ * Downscaled copies of the images in the BlobStore, so the popup doesn't have
+ * to decode full resolution screenshots.
+ *
+ * A thumbnail fits in a square of one of the bucket sizes and is stored in
+ * data/thumbnails/<bucket>/<data uuid>.png. The file name starts with the data
+ * uuid of the image, so BlobStore::compact() deletes the thumbnails together
+ * with their image. All functions are safe to call from any thread.
+ */
+class KLIPPER_EXPORT ThumbnailCache
+{
+public:
+    static constexpr std::array<int, 3> s_buckets{128, 256, 512};
+
+    /**
+     * @return the smallest bucket that can serve @p requestedSize, or the largest one
+     */
+    static int bucket(const QSize &requestedSize);
+
+    static QString path(QStringView dbFolder, QStringView dataUuid, int bucket);
+
+    /**
+     * Saves a thumbnail of @p image for every bucket smaller than the image.
+     * Called when the image is added to the history.
+     */
+    static void generate(QStringView dbFolder, QStringView dataUuid, const QImage &image);
+
+    /**
+     * Loads the thumbnail of the image @p dataUuid that is large enough for @p requestedSize.
+     * A missing thumbnail is generated from the image and saved.
+     *
+     * @return the image scaled to fit in @p requestedSize, or a null image if the image is not in the store
+     */
+    static QImage load(QStringView dbFolder, QStringView dataUuid, const QSize &requestedSize);
+};
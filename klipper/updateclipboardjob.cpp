@@ -6,18 +6,18 @@
 
 #include "updateclipboardjob.h"
 
+#include <numeric>
+
 #include <QBuffer>
 #include <QCryptographicHash>
-#include <QImage>
 #include <QImageWriter>
 #include <QMimeData>
 #include <QSqlDatabase>
-#include <QSqlError>
-#include <QSqlQuery>
-#include <QUrl>
+#include <QtConcurrentRun>
 
-#include <KIO/MkdirJob>
-#include <KIO/StoredTransferJob>
+#include "blobstore.h"
+#include "databasewritequeue.h"
+#include "thumbnailcache.h"
 
 using namespace Qt::StringLiterals;
 
@@ -28,39 +28,86 @@ constexpr std::array<QStringView, 3> s_acceptableTextFormatPrefixes{
     u"application/json",
     u"application/xml",
 };
-}
 
-UpdateDatabaseJob *UpdateDatabaseJob::updateClipboard(QObject *parent,
-                                                      QSqlDatabase *database,
-                                                      QStringView databaseFolder,
-                                                      const QString &uuid,
-                                                      const QString &text,
-                                                      const QMimeData *mimeData,
-                                                      qreal timestamp)
+/**
+ * Runs on a worker thread: hashes and encodes every format of the snapshot and saves them to the blob store
+ */
+UpdateDatabaseJob::SaveResult saveSnapshot(const MimeDataSnapshot &snapshot, const QString &dbFolder)
 {
+    UpdateDatabaseJob::SaveResult result;
     QCryptographicHash hash(QCryptographicHash::Sha1);
-    std::list<MimeData> mimeDataList;
-    const QStringList formats = mimeData->formats();
 
-    if (mimeData->hasText()) {
-        QByteArray data = mimeData->text().toUtf8();
+    if (snapshot.hasText) {
+        QByteArray data = snapshot.text.toUtf8();
         hash.addData(data);
-        mimeDataList.emplace_back(s_plainTextPrefix, std::move(data), QString::fromLatin1(hash.result().toHex()));
-        mimeDataList.emplace_back(s_plainUtf8Text, QByteArray() /*Same uuid*/, QString::fromLatin1(hash.result().toHex()));
+        result.mimeDataList.emplace_back(s_plainTextPrefix, std::move(data), QString::fromLatin1(hash.result().toHex()));
+        result.mimeDataList.emplace_back(s_plainUtf8Text, QByteArray() /*Same uuid*/, QString::fromLatin1(hash.result().toHex()));
     }
 
-    if (mimeData->hasImage()) {
-        QImage image = mimeData->imageData().value<QImage>();
-        hash.reset();
-        hash.addData(QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()));
+    if (snapshot.hasImage) {
+        QString imageDataUuid = snapshot.imageDataUuid;
+        if (imageDataUuid.isEmpty()) {
+            hash.reset();
+            hash.addData(QByteArrayView(reinterpret_cast<const char *>(snapshot.image.constBits()), snapshot.image.sizeInBytes()));
+            imageDataUuid = QString::fromLatin1(hash.result().toHex());
+        }
         QByteArray data;
         QBuffer buffer(&data);
         QImageWriter encoder(&buffer, "PNG");
-        encoder.write(image);
-        mimeDataList.emplace_back(s_imageFormat, std::move(data), QString::fromLatin1(hash.result().toHex()));
+        encoder.write(snapshot.image);
+        result.mimeDataList.emplace_back(s_imageFormat, std::move(data), std::move(imageDataUuid));
+    }
+
+    for (const auto &[format, data] : snapshot.extraFormats) {
+        hash.reset();
+        hash.addData(data);
+        result.mimeDataList.emplace_back(format, data, QString::fromLatin1(hash.result().toHex()));
+    }
+
+    QSet<QString> savedUuidList;
+    for (MimeData &data : result.mimeDataList) {
+        // Different mimetypes can refer to the same content. Often happens between text/plain;charset=utf-8 and text/plain
+        if (savedUuidList.contains(data.uuid)) {
+            continue;
+        }
+        savedUuidList.insert(data.uuid);
+        if (!BlobStore::save(dbFolder, data.uuid, data.data, &result.errorString)) {
+            return result;
+        }
+        data.size = data.data.size();
+        data.data.clear(); // Only the uuid is needed from now on
     }
 
-    for (const QString &format : formats) {
+    // The image is decoded already, so the popup never has to decode the full image
+    if (auto it = std::find_if(result.mimeDataList.cbegin(),
+                               result.mimeDataList.cend(),
+                               [](const MimeData &data) {
+                                   return data.type == s_imageFormat;
+                               });
+        it != result.mimeDataList.cend()) {
+        ThumbnailCache::generate(dbFolder, it->uuid, snapshot.image);
+    }
+
+    return result;
+}
+}
+
+MimeDataSnapshot MimeDataSnapshot::fromMimeData(const QMimeData *mimeData)
+{
+    MimeDataSnapshot snapshot;
+    if (mimeData->hasText()) {
+        snapshot.hasText = true;
+        snapshot.text = mimeData->text();
+    }
+    if (mimeData->hasUrls()) {
+        snapshot.urls = mimeData->urls();
+    }
+    if (mimeData->hasImage()) {
+        snapshot.hasImage = true;
+        snapshot.image = mimeData->imageData().value<QImage>();
+    }
+
+    for (const QStringList formats = mimeData->formats(); const QString &format : formats) {
         if (!format.contains(u'/')) {
             continue;
         }
@@ -84,29 +131,89 @@ UpdateDatabaseJob *UpdateDatabaseJob::updateClipboard(QObject *parent,
             continue;
         }
 
-        hash.reset();
-        hash.addData(data);
-        mimeDataList.emplace_back(format, std::move(data), QString::fromLatin1(hash.result().toHex()));
+        snapshot.extraFormats.emplace_back(format, std::move(data));
     }
 
-    return new UpdateDatabaseJob(parent, database, databaseFolder, uuid, text, std::move(mimeDataList), timestamp);
+    return snapshot;
+}
+
+QStringList MimeDataSnapshot::mimeTypes() const
+{
+    QStringList types;
+    if (hasText) {
+        types << s_plainTextPrefix << s_plainUtf8Text;
+    }
+    if (hasImage) {
+        types << s_imageFormat;
+    }
+    for (const auto &format : extraFormats) {
+        types << format.first;
+    }
+    return types;
+}
+
+qsizetype MimeDataSnapshot::hashedSize() const
+{
+    qsizetype size = hasText ? text.size() : 0;
+    for (const QUrl &url : urls) {
+        size += url.url().size();
+    }
+    if (hasImage) {
+        size += image.sizeInBytes();
+    }
+    return size;
+}
+
+void MimeDataSnapshot::computeUuid()
+{
+    const QByteArrayView pixels = hasImage ? QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()) : QByteArrayView();
+    if (hasImage) {
+        imageDataUuid = QString::fromLatin1(QCryptographicHash::hash(pixels, QCryptographicHash::Sha1).toHex());
+        if (!hasText && urls.empty()) {
+            // The usual screenshot, both hashes are the same
+            uuid = imageDataUuid;
+            return;
+        }
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (hasText) {
+        hash.addData(text.toUtf8());
+    }
+    for (const QUrl &url : urls) {
+        hash.addData(url.toEncoded());
+    }
+    hash.addData(pixels);
+    uuid = QString::fromLatin1(hash.result().toHex());
+}
+
+UpdateDatabaseJob *UpdateDatabaseJob::updateClipboard(QObject *parent,
+                                                      DatabaseWriteQueue *writeQueue,
+                                                      QStringView databaseFolder,
+                                                      const QString &uuid,
+                                                      const QString &text,
+                                                      const MimeDataSnapshot &snapshot,
+                                                      qreal timestamp)
+{
+    return new UpdateDatabaseJob(parent, writeQueue, databaseFolder, uuid, text, snapshot, timestamp);
 }
 
 UpdateDatabaseJob::UpdateDatabaseJob(QObject *parent,
-                                     QSqlDatabase *database,
+                                     DatabaseWriteQueue *writeQueue,
                                      QStringView databaseFolder,
                                      const QString &uuid,
                                      const QString &text,
-                                     std::list<MimeData> &&mimeDataList,
+                                     const MimeDataSnapshot &snapshot,
                                      qreal timestamp)
-    : KCompositeJob(parent)
-    , m_db(database)
+    : KJob(parent)
+    , m_writeQueue(writeQueue)
     , m_uuid(uuid)
     , m_text(text)
-    , m_dataDir(databaseFolder + u"/data/")
-    , m_mimeDataList(std::move(mimeDataList))
+    , m_dbFolder(databaseFolder.toString())
+    , m_snapshot(snapshot)
     , m_timestamp(timestamp)
 {
+    connect(&m_watcher, &QFutureWatcher<SaveResult>::finished, this, &UpdateDatabaseJob::onDataSaved);
 }
 
 UpdateDatabaseJob::~UpdateDatabaseJob()
@@ -115,78 +222,55 @@ UpdateDatabaseJob::~UpdateDatabaseJob()
 
 void UpdateDatabaseJob::start()
 {
-    if (!m_db->isOpen()) [[unlikely]] {
+    if (!m_writeQueue->database().isOpen()) [[unlikely]] {
         setErrorText(u"Invalid database"_s);
         setError(DatabaseError);
         emitResult();
         return;
     }
 
-    QSqlQuery query(*m_db);
-    query.prepare(u"INSERT INTO main (uuid, added_time, last_used_time, mimetypes, text, starred) VALUES (?, ?, ?, ?, ?, ?)"_s);
-    query.addBindValue(m_uuid);
-    if (m_timestamp == 0) [[likely]] {
-        query.addBindValue(QDateTime::currentMSecsSinceEpoch() / 1000.0);
-        query.addBindValue(QDateTime::currentMSecsSinceEpoch() / 1000.0);
-    } else {
-        query.addBindValue(qreal(m_timestamp));
-        query.addBindValue(qreal(m_timestamp));
-    }
-    query.addBindValue(std::accumulate(std::next(m_mimeDataList.begin()),
-                                       m_mimeDataList.end(),
-                                       m_mimeDataList.begin()->type,
-                                       [](const QString &a, const MimeData &b) -> QString {
-                                           return a + u',' + b.type;
-                                       }));
-    query.addBindValue(m_text);
-    query.addBindValue(false); // New items are not starred by default
-    if (!query.exec()) {
-        setErrorText(query.lastError().text());
-        setError(DatabaseError);
-        emitResult();
-        return;
-    }
+    const qreal timestamp = m_timestamp == 0 ? QDateTime::currentMSecsSinceEpoch() / 1000.0 : m_timestamp;
+    m_writeQueue->enqueue(u"INSERT INTO main (uuid, added_time, last_used_time, mimetypes, text, starred) VALUES (?, ?, ?, ?, ?, ?)"_s,
+                          {m_uuid,
+                           timestamp,
+                           timestamp,
+                           m_snapshot.mimeTypes().join(u','),
+                           m_text,
+                           false /* New items are not starred by default */});
 
-    auto mkdirJob = KIO::mkdir(QUrl::fromLocalFile(m_dataDir + m_uuid));
-    connect(mkdirJob, &KJob::finished, this, &UpdateDatabaseJob::onDataDirReady);
+    m_watcher.setFuture(QtConcurrent::run(saveSnapshot, std::move(m_snapshot), m_dbFolder));
 }
 
-void UpdateDatabaseJob::onDataDirReady(KJob *job)
+QString UpdateDatabaseJob::dataUuid(QStringView mimeType) const
 {
-    if (job->error()) {
-        setError(job->error());
-        setErrorText(job->errorText());
-        emitResult();
-        return;
-    }
-
-    QSet<QStringView> addedUuidList;
-    for (const MimeData &data : m_mimeDataList) {
-        QSqlQuery query(*m_db);
-        query.prepare(u"INSERT INTO aux (uuid, mimetype, data_uuid) VALUES (?, ?, ?)"_s);
-        query.addBindValue(m_uuid);
-        query.addBindValue(data.type);
-        query.addBindValue(data.uuid);
-        if (query.exec()) {
-            // Different mimetypes can refer to the same content. Often happens between text/plain;charset=utf-8 and text/plain
-            if (QStringView uuid(data.uuid); !addedUuidList.contains(uuid)) {
-                addedUuidList.insert(uuid);
-                KIO::StoredTransferJob *fileJob =
-                    KIO::storedPut(data.data, QUrl::fromLocalFile(QString(m_dataDir + m_uuid + u'/' + data.uuid)), -1, KIO::HideProgressInfo);
-                addSubjob(fileJob);
-            }
-        }
-    }
+    auto it = std::find_if(m_mimeDataList.cbegin(), m_mimeDataList.cend(), [mimeType](const MimeData &data) {
+        return data.type == mimeType;
+    });
+    return it == m_mimeDataList.cend() ? QString() : it->uuid;
 }
 
-void UpdateDatabaseJob::slotResult(KJob *job)
+qint64 UpdateDatabaseJob::dataSize() const
 {
-    removeSubjob(job);
+    return std::accumulate(m_mimeDataList.cbegin(), m_mimeDataList.cend(), qint64(0), [](qint64 size, const MimeData &data) {
+        return size + data.size;
+    });
+}
 
-    if (hasSubjobs()) {
+void UpdateDatabaseJob::onDataSaved()
+{
+    SaveResult result = m_watcher.result();
+    if (!result.errorString.isEmpty()) {
+        setError(WriteError);
+        setErrorText(result.errorString);
+        emitResult();
         return;
     }
 
+    m_mimeDataList = std::move(result.mimeDataList);
+    for (const MimeData &data : std::as_const(m_mimeDataList)) {
+        m_writeQueue->enqueue(u"INSERT INTO aux (uuid, mimetype, data_uuid) VALUES (?, ?, ?)"_s, {m_uuid, data.type, data.uuid});
+    }
+
     emitResult();
 }
 
@@ -6,10 +6,14 @@
 
 #pragma once
 
-#include <KCompositeJob>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QUrl>
 
+#include <KJob>
+
+class DatabaseWriteQueue;
 class QMimeData;
-class QSqlDatabase;
 
 inline constexpr QLatin1String s_imageFormat("image/png");
 inline constexpr QLatin1String s_plainTextPrefix("text/plain");
@@ -19,48 +23,106 @@ struct MimeData {
     QString type;
     QByteArray data;
     QString uuid;
+    /// The size of the saved data, 0 if another format of the clip refers to the same data
+    qint64 size = 0;
+};
+
+/**
+ * A copy of the clipboard payload, taken once on the GUI thread so hashing,
+ * encoding and saving can run on a worker thread after the QMimeData is gone.
+ */
+struct MimeDataSnapshot {
+    static MimeDataSnapshot fromMimeData(const QMimeData *mimeData);
+
+    /**
+     * @return the mime types that will be saved for this snapshot, in the order they are saved
+     */
+    QStringList mimeTypes() const;
+
+    /**
+     * @return roughly the number of bytes computeUuid() has to hash
+     */
+    qsizetype hashedSize() const;
+
+    /**
+     * Sets uuid to the SHA1 of the text, urls and image pixels, and imageDataUuid to
+     * the SHA1 of the image pixels alone, so saving the image doesn't hash it again.
+     */
+    void computeUuid();
+
+    /// The uuid of the history item, empty until computeUuid() ran
+    QString uuid;
+    /// The uuid the image data is saved under, empty until computeUuid() ran
+    QString imageDataUuid;
+    bool hasText = false;
+    QString text;
+    QList<QUrl> urls;
+    bool hasImage = false;
+    QImage image;
+    std::list<std::pair<QString, QByteArray>> extraFormats;
 };
 
 /**
- * A composite job that saves a clip to a local folder and updates the database
+ * A job that saves a clip to a local folder and updates the database.
+ *
+ * Hashing, image encoding and the file writes run on the global thread pool.
+ * The database rows are queued in a DatabaseWriteQueue, so they may not be written yet
+ * when the job finishes.
  */
-class UpdateDatabaseJob : public KCompositeJob
+class UpdateDatabaseJob : public KJob
 {
     Q_OBJECT
 
 public:
     enum {
         DatabaseError = KJob::UserDefinedError,
+        WriteError,
     };
 
     static UpdateDatabaseJob *updateClipboard(QObject *parent,
-                                              QSqlDatabase *database,
+                                              DatabaseWriteQueue *writeQueue,
                                               QStringView databaseFolder,
                                               const QString &uuid,
                                               const QString &text,
-                                              const QMimeData *mimeData,
+                                              const MimeDataSnapshot &snapshot,
                                               qreal timestamp);
     ~UpdateDatabaseJob() override;
 
     void start() override;
 
+    /**
+     * @return the uuid of the data saved for @p mimeType, or an empty string if there is none
+     */
+    QString dataUuid(QStringView mimeType) const;
+
+    /**
+     * @return the number of bytes saved for the clip
+     */
+    qint64 dataSize() const;
+
+    struct SaveResult {
+        std::list<MimeData> mimeDataList;
+        QString errorString;
+    };
+
 protected:
     explicit UpdateDatabaseJob(QObject *parent,
-                               QSqlDatabase *database,
+                               DatabaseWriteQueue *writeQueue,
                                QStringView databaseFolder,
                                const QString &uuid,
                                const QString &text,
-                               std::list<MimeData> &&mimeDataList,
+                               const MimeDataSnapshot &snapshot,
                                qreal timestamp);
 
 private:
-    void onDataDirReady(KJob *job);
-    void slotResult(KJob *job) override;
+    void onDataSaved();
 
-    QSqlDatabase *m_db = nullptr;
+    DatabaseWriteQueue *m_writeQueue = nullptr;
     QString m_uuid;
     QString m_text;
-    QString m_dataDir;
+    QString m_dbFolder;
+    MimeDataSnapshot m_snapshot;
     std::list<MimeData> m_mimeDataList;
     qreal m_timestamp;
+    QFutureWatcher<SaveResult> m_watcher;
 };
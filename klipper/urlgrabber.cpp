@@ -22,6 +22,7 @@
 #include <KNotificationJobUiDelegate>
 #include <KService>
 #include <KStringHandler>
+#include <KSycoca>
 #include <KWindowInfo>
 #include <KX11Extras>
 
@@ -42,6 +43,9 @@ URLGrabber::URLGrabber(QObject *parent)
 {
     m_myPopupKillTimer->setSingleShot(true);
     connect(m_myPopupKillTimer, &QTimer::timeout, this, &URLGrabber::slotKillPopupMenu);
+    connect(KSycoca::self(), &KSycoca::databaseChanged, this, [this] {
+        m_mimeServices.clear();
+    });
 }
 
 URLGrabber::~URLGrabber()
@@ -90,7 +94,7 @@ void URLGrabber::matchingMimeActions(const QString &clipData)
     }
 
     // try to figure out if clipData contains a filename
-    QMimeDatabase db;
+    static const QMimeDatabase db;
     QMimeType mimetype = db.mimeTypeForUrl(url);
 
     // let's see if we found some reasonable mimetype.
@@ -106,8 +110,11 @@ void URLGrabber::matchingMimeActions(const QString &clipData)
     }
 
     if (!mimetype.isDefault()) {
-        const KService::List lst = KApplicationTrader::queryByMimeType(mimetype.name());
-        if (!lst.isEmpty()) {
+        auto it = m_mimeServices.constFind(mimetype.name());
+        if (it == m_mimeServices.cend()) {
+            it = m_mimeServices.insert(mimetype.name(), KApplicationTrader::queryByMimeType(mimetype.name()));
+        }
+        if (const KService::List &lst = *it; !lst.isEmpty()) {
             ClipAction *action = new ClipAction(QString(), mimetype.comment());
             for (const KService::Ptr &service : lst) {
                 action->addCommand(ClipCommand(QString(), service->name(), true, service->icon(), ClipCommand::IGNORE, service->storageId()));
@@ -124,11 +131,12 @@ const ActionList &URLGrabber::matchingActions(const QString &clipData, bool auto
     matchingMimeActions(clipData);
 
     // now look for matches in custom user actions
-    QRegularExpression re;
     for (ClipAction *action : std::as_const(m_myActions)) {
-        re.setPattern(action->actionRegexPattern());
-        const QRegularExpressionMatch match = re.match(clipData);
-        if (match.hasMatch() && (action->automatic() || !automatically_invoked)) {
+        if (automatically_invoked && !action->automatic()) {
+            continue;
+        }
+        const QRegularExpressionMatch match = action->actionRegex().match(clipData);
+        if (match.hasMatch()) {
             action->setActionCapturedTexts(match.capturedTexts());
             m_myMatches.append(action);
         }
@@ -350,18 +358,18 @@ ClipCommand::ClipCommand(const QString &_command,
 }
 
 ClipAction::ClipAction(const QString &regExp, const QString &description, bool automatic)
-    : m_regexPattern(regExp)
-    , m_myDescription(description)
+    : m_myDescription(description)
     , m_automatic(automatic)
 {
+    setActionRegexPattern(regExp);
 }
 
 ClipAction::ClipAction(KSharedConfigPtr kc, const QString &group)
-    : m_regexPattern(kc->group(group).readEntry("Regexp"))
-    , m_myDescription(kc->group(group).readEntry("Description"))
+    : m_myDescription(kc->group(group).readEntry("Description"))
     , m_automatic(kc->group(group).readEntry("Automatic", QVariant(true)).toBool())
 {
     KConfigGroup cg(kc, group);
+    setActionRegexPattern(cg.readEntry("Regexp"));
 
     int num = cg.readEntry("Number of commands", 0);
 
@@ -383,6 +391,13 @@ ClipAction::~ClipAction()
     m_myCommands.clear();
 }
 
+void ClipAction::setActionRegexPattern(const QString &pattern)
+{
+    m_regex.setPattern(pattern);
+    // Compile (and JIT) now instead of on the first clipboard change
+    m_regex.optimize();
+}
+
 void ClipAction::addCommand(const ClipCommand &cmd)
 {
     if (cmd.command.isEmpty() && cmd.serviceStorageId.isEmpty())
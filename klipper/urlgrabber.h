@@ -8,8 +8,10 @@
 #include <memory>
 
 #include <QHash>
+#include <QRegularExpression>
 #include <QStringList>
 
+#include <KService>
 #include <KSharedConfig>
 
 #include "klipper_export.h"
@@ -92,12 +94,16 @@ private:
 
     // holds mappings of menu action IDs to action commands (action+cmd index in it)
     QHash<QString, QPair<ClipAction *, int>> m_myCommandMapper;
+    // mimetype name -> applications that can open it, cleared when sycoca changes
+    QHash<QString, KService::List> m_mimeServices;
     QMenu *m_myMenu;
     QTimer *m_myPopupKillTimer;
     int m_myPopupKillTimeout;
     bool m_stripWhiteSpace;
     HistoryCycler *m_history;
 
+    friend class URLGrabberTest;
+
 private Q_SLOTS:
     void slotItemSelected(QAction *action);
     void slotKillPopupMenu();
@@ -106,7 +112,7 @@ Q_SIGNALS:
     void sigPopup(QMenu *);
 };
 
-struct ClipCommand {
+struct KLIPPER_EXPORT ClipCommand {
     /**
      * What to do with output of command
      */
@@ -138,7 +144,7 @@ struct ClipCommand {
  * expression, an (optional) description and a list of ClipCommands
  * (a command to be executed, a description and an enabled/disabled flag).
  */
-class ClipAction
+class KLIPPER_EXPORT ClipAction
 {
 public:
     explicit ClipAction(const QString &regExp = QString(), const QString &description = QString(), bool automagic = true);
@@ -148,11 +154,16 @@ public:
 
     QString actionRegexPattern() const
     {
-        return m_regexPattern;
+        return m_regex.pattern();
     }
-    void setActionRegexPattern(const QString &pattern)
+    void setActionRegexPattern(const QString &pattern);
+
+    /**
+     * The compiled action pattern, ready to be matched against every new clip
+     */
+    const QRegularExpression &actionRegex() const
     {
-        m_regexPattern = pattern;
+        return m_regex;
     }
 
     QStringList actionCapturedTexts() const
@@ -216,7 +227,7 @@ public:
     void save(KSharedConfigPtr, const QString &) const;
 
 private:
-    QString m_regexPattern;
+    QRegularExpression m_regex;
     QStringList m_regexCapturedTexts;
     QString m_myDescription;
     QList<ClipCommand> m_myCommands;
@@ -10,6 +10,7 @@
 
 #include "utils_p.h"
 
+#include "imagecache_p.h"
 #include "notification_p.h"
 
 #include <QDBusConnection>
@@ -40,8 +41,8 @@ AbstractNotificationsModel::Private::Private(AbstractNotificationsModel *q)
         QList<int> rowsToBeRemoved;
         rowsToBeRemoved.reserve(pendingRemovals.count());
         for (uint id : std::as_const(pendingRemovals)) {
-            Notification::Private::s_imageCache.remove(id);
-            int row = q->rowOfNotification(id); // oh the complexity...
+            ImageCache::self().remove(id);
+            const int row = q->rowOfNotification(id);
             if (row == -1) {
                 continue;
             }
@@ -83,11 +84,14 @@ void AbstractNotificationsModel::Private::onNotificationAdded(const Notification
                                      << "notifications";
         q->beginRemoveRows(QModelIndex(), 0, cleanupCount - 1);
         for (int i = 0; i < cleanupCount; ++i) {
-            Notification::Private::s_imageCache.remove(notifications.at(0).id());
-            q->stopTimeout(notifications.first().id());
-            notifications.removeAt(0);
+            const uint id = notifications.at(i).id();
+            ImageCache::self().remove(id);
+            q->stopTimeout(id);
+            rowIndex.remove(id);
             // TODO close gracefully?
         }
+        notifications.remove(0, cleanupCount);
+        updateRowIndex(0);
         q->endRemoveRows();
     }
 
@@ -99,6 +103,7 @@ void AbstractNotificationsModel::Private::onNotificationAdded(const Notification
     }
 
     q->beginInsertRows(QModelIndex(), notifications.count(), notifications.count());
+    rowIndex.insert(notification.id(), notifications.count());
     notifications.append(std::move(notification));
     q->endInsertRows();
 }
@@ -129,6 +134,10 @@ void AbstractNotificationsModel::Private::onNotificationReplaced(uint replacedId
     newNotification.setWasAddedDuringInhibition(Server::self().inhibited());
 
     notifications[row] = newNotification;
+    if (newNotification.id() != replacedId) {
+        rowIndex.remove(replacedId);
+        rowIndex.insert(newNotification.id(), row);
+    }
     const QModelIndex idx = q->index(row, 0);
     Q_EMIT q->dataChanged(idx, idx);
 }
@@ -172,9 +181,7 @@ void AbstractNotificationsModel::Private::onNotificationRemoved(uint removedId,
     // some apps are notorious for closing a bunch of notifications at once
     // causing newer notifications to move up and have a dialogs created for them
     // just to then be discarded causing excess CPU usage
-    if (!pendingRemovals.contains(removedId)) {
-        pendingRemovals.append(removedId);
-    }
+    pendingRemovals.insert(removedId);
 
     if (!pendingRemovalTimer.isActive()) {
         pendingRemovalTimer.start();
@@ -240,9 +247,12 @@ void AbstractNotificationsModel::Private::removeRows(const QList<int> &rows)
 
         q->beginRemoveRows(QModelIndex(), range.first, range.second);
         for (int j = range.second; j >= range.first; --j) {
-            notifications.removeAt(j);
+            rowIndex.remove(notifications.at(j).id());
             ++rowsRemoved;
         }
+        notifications.remove(range.first, range.second - range.first + 1);
+        // Rows past this range move up, the ones before it are as they were
+        updateRowIndex(range.first);
         q->endRemoveRows();
     }
 
@@ -251,17 +261,16 @@ void AbstractNotificationsModel::Private::removeRows(const QList<int> &rows)
     pendingRemovals.clear();
 }
 
-int AbstractNotificationsModel::rowOfNotification(uint id) const
+void AbstractNotificationsModel::Private::updateRowIndex(int from)
 {
-    auto it = std::find_if(d->notifications.constBegin(), d->notifications.constEnd(), [id](const Notification &item) {
-        return item.id() == id;
-    });
-
-    if (it == d->notifications.constEnd()) {
-        return -1;
+    for (int row = from; row < notifications.count(); ++row) {
+        rowIndex.insert(notifications.at(row).id(), row);
     }
+}
 
-    return std::distance(d->notifications.constBegin(), it);
+int AbstractNotificationsModel::rowOfNotification(uint id) const
+{
+    return d->rowIndex.value(id, -1);
 }
 
 AbstractNotificationsModel::AbstractNotificationsModel()
@@ -11,6 +11,7 @@
 
 #include <QDBusServiceWatcher>
 #include <QDateTime>
+#include <QSet>
 #include <QTimer>
 
 namespace NotificationManager
@@ -28,10 +29,13 @@ public:
     void setupNotificationTimeout(const Notification &notification);
 
     void removeRows(const QList<int> &rows);
+    void updateRowIndex(int from);
 
     AbstractNotificationsModel *q;
 
     QList<Notification> notifications;
+    // Notifications are looked up by id a lot, e.g. when a progress notification gets replaced
+    QHash<uint /*notificationId*/, int /*row*/> rowIndex;
     // Fallback timeout to ensure all notifications expire eventually
     // otherwise when it isn't shown to the user and doesn't expire
     // an app might wait indefinitely for the notification to do so
@@ -44,7 +48,7 @@ public:
     // they are not.
     QDBusServiceWatcher notificationWatcher;
 
-    QList<uint /*notificationId*/> pendingRemovals;
+    QSet<uint /*notificationId*/> pendingRemovals;
     QTimer pendingRemovalTimer;
 
     QDateTime lastRead;
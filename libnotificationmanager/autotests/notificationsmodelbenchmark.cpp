@@ -0,0 +1,158 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "notification.h"
+#include "notifications.h"
+#include "notificationsmodel.h"
+#include "server.h"
+
+using namespace Qt::StringLiterals;
+
+namespace NotificationManager
+{
+/**
+ * Measures how NotificationsModel copes with notifications coming and going
+ * through Server, as they would for Notify and CloseNotification calls on the bus.
+ */
+class NotificationsModelBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void testRowIndex();
+
+    void benchmarkNotifyClose();
+    void benchmarkReplace_data();
+    void benchmarkReplace();
+
+private:
+    static uint notify(const QString &summary, uint replacesId = 0);
+    QString summary(int row) const;
+
+    NotificationsModel::Ptr m_model;
+};
+
+void NotificationsModelBenchmark::initTestCase()
+{
+    m_model = NotificationsModel::createNotificationsModel();
+}
+
+void NotificationsModelBenchmark::cleanup()
+{
+    for (int row = m_model->rowCount() - 1; row >= 0; --row) {
+        Server::self().closeNotification(m_model->index(row, 0).data(Notifications::IdRole).toUInt(), Server::CloseReason::Revoked);
+    }
+    QTRY_COMPARE(m_model->rowCount(), 0);
+}
+
+uint NotificationsModelBenchmark::notify(const QString &summary, uint replacesId)
+{
+    Notification notification(replacesId);
+    notification.setSummary(summary);
+    return Server::self().add(notification);
+}
+
+QString NotificationsModelBenchmark::summary(int row) const
+{
+    return m_model->index(row, 0).data(Notifications::SummaryRole).toString();
+}
+
+void NotificationsModelBenchmark::testRowIndex()
+{
+    QList<uint> ids;
+    for (int i = 0; i < 10; ++i) {
+        ids.append(notify(u"Notification %1"_s.arg(i)));
+    }
+
+    // Close a few at once, leaving gaps
+    for (int i : {1, 2, 5, 8}) {
+        Server::self().closeNotification(ids.at(i), Server::CloseReason::Revoked);
+    }
+    QTRY_COMPARE(m_model->rowCount(), 6);
+
+    // Everything that's left is still found where it moved to
+    const QList<int> remaining{0, 3, 4, 6, 7, 9};
+    for (int row = 0; row < remaining.count(); ++row) {
+        notify(u"Replaced %1"_s.arg(remaining.at(row)), ids.at(remaining.at(row)));
+    }
+    QCOMPARE(m_model->rowCount(), 6);
+    for (int row = 0; row < remaining.count(); ++row) {
+        QCOMPARE(summary(row), u"Replaced %1"_s.arg(remaining.at(row)));
+    }
+
+    // Reaching the limit discards the oldest half
+    uint last = 0;
+    for (int i = 0; i < 1000; ++i) {
+        last = notify(u"Flood %1"_s.arg(i));
+    }
+    QCOMPARE(m_model->rowCount(), 506);
+    QCOMPARE(summary(0), u"Flood 494"_s);
+
+    notify(u"Replaced flood"_s, last);
+    QCOMPARE(m_model->rowCount(), 506);
+    QCOMPARE(summary(505), u"Replaced flood"_s);
+
+    Server::self().closeNotification(ids.at(0), Server::CloseReason::Revoked);
+    Server::self().closeNotification(last, Server::CloseReason::Revoked);
+    QTRY_COMPARE(m_model->rowCount(), 505);
+    QCOMPARE(summary(504), u"Flood 998"_s);
+}
+
+void NotificationsModelBenchmark::benchmarkNotifyClose()
+{
+    // 10k calls, with the closed notifications piling up until the batched removal runs
+    QBENCHMARK {
+        for (int i = 0; i < 5000; ++i) {
+            const uint id = notify(u"Build %1 finished"_s.arg(i));
+            Server::self().closeNotification(id, Server::CloseReason::Revoked);
+        }
+    }
+
+    QTRY_COMPARE(m_model->rowCount(), 0);
+}
+
+void NotificationsModelBenchmark::benchmarkReplace_data()
+{
+    QTest::addColumn<int>("historySize");
+
+    QTest::newRow("10 in history") << 10;
+    QTest::newRow("100 in history") << 100;
+    QTest::newRow("900 in history") << 900;
+}
+
+void NotificationsModelBenchmark::benchmarkReplace()
+{
+    QFETCH(int, historySize);
+
+    for (int i = 0; i < historySize; ++i) {
+        notify(u"Notification %1"_s.arg(i));
+    }
+
+    // A progress notification updated over and over, after everything in the history
+    const uint progressId = notify(u"Progress"_s);
+
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (int i = 0; i < 10000; ++i) {
+            notify(u"Progress %1 (%2)"_s.arg(i).arg(round), progressId);
+        }
+    }
+
+    QCOMPARE(m_model->rowCount(), historySize + 1);
+}
+
+} // namespace NotificationManager
+
+QTEST_GUILESS_MAIN(NotificationManager::NotificationsModelBenchmark)
+
+#include "notificationsmodelbenchmark.moc"
@@ -0,0 +1,214 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "imagecache_p.h"
+
+#include <QCryptographicHash>
+#include <QPromise>
+#include <QtConcurrentRun>
+
+#include <optional>
+
+using namespace NotificationManager;
+
+ImageCache &ImageCache::self()
+{
+    static ImageCache s_self;
+    return s_self;
+}
+
+bool ImageCache::contains(uint id) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_keys.contains(id);
+}
+
+QImage ImageCache::image(uint id)
+{
+    QMutexLocker locker(&m_mutex);
+    if (const QImage *image = m_images.object(m_keys.value(id))) {
+        return *image;
+    }
+    return QImage();
+}
+
+void ImageCache::insert(uint id, const QImage &image)
+{
+    if (image.isNull()) {
+        remove(id);
+        return;
+    }
+
+    const QByteArray key = ImageCache::key(image);
+    QMutexLocker locker(&m_mutex);
+    ref(id, key);
+    if (!m_images.contains(key)) {
+        store(key, image);
+    }
+}
+
+QFuture<QImage> ImageCache::insert(uint id, const QByteArray &key, std::function<QImage()> decode)
+{
+    QMutexLocker locker(&m_mutex);
+    ref(id, key);
+
+    if (const auto it = m_decoding.constFind(key); it != m_decoding.constEnd()) {
+        return it->future;
+    }
+
+    if (const QImage *image = m_images.object(key)) {
+        return QtFuture::makeReadyValueFuture(*image);
+    }
+
+    // The decode stores its result itself: a continuation of an already finished
+    // future would run right here, with the lock held. It waits for the lock
+    // instead, so the decode is known by the time it finishes.
+    const quint64 serial = ++m_lastDecoding;
+    QFuture<QImage> future = QtConcurrent::run([this, key, serial, decode = std::move(decode)] {
+        const QImage image = decode();
+        QMutexLocker locker(&m_mutex);
+        finishDecoding(key, serial, image);
+        return image;
+    });
+    m_decoding.insert(key, Decoding{.future = future, .serial = serial});
+    return future;
+}
+
+QFuture<QImage> ImageCache::insert(uint id, std::function<QByteArray()> key, std::function<QImage()> decode)
+{
+    QMutexLocker locker(&m_mutex);
+    const QByteArray placeholder = QByteArrayLiteral("placeholder:") + QByteArray::number(++m_lastPlaceholder);
+    ref(id, placeholder);
+
+    return QtConcurrent::run([this, id, placeholder, key = std::move(key), decode = std::move(decode)] {
+        const QByteArray imageKey = key();
+
+        QImage image;
+        QFuture<QImage> running;
+        // Lets notifications with the same image join this decode
+        std::optional<QPromise<QImage>> promise;
+        quint64 serial = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (const QImage *cachedImage = m_images.object(imageKey)) {
+                image = *cachedImage;
+            } else if (const auto it = m_decoding.constFind(imageKey); it != m_decoding.constEnd()) {
+                running = it->future;
+            } else {
+                promise.emplace();
+                promise->start();
+                serial = ++m_lastDecoding;
+                m_decoding.insert(imageKey, Decoding{.future = promise->future(), .serial = serial});
+            }
+        }
+        if (running.isValid()) {
+            image = running.result();
+        } else if (promise) {
+            image = decode();
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            // Unless the notification got another image or went away in the meantime
+            if (m_keys.value(id) == placeholder) {
+                ref(id, imageKey);
+            }
+            if (promise) {
+                finishDecoding(imageKey, serial, image);
+            } else if (m_refs.contains(imageKey) && !m_images.contains(imageKey)) {
+                store(imageKey, image);
+            }
+        }
+
+        if (promise) {
+            promise->addResult(image);
+            promise->finish();
+        }
+        return image;
+    });
+}
+
+void ImageCache::remove(uint id)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_keys.constFind(id);
+    if (it == m_keys.constEnd()) {
+        return;
+    }
+
+    const QByteArray key = *it;
+    m_keys.erase(it);
+    unref(key);
+}
+
+void ImageCache::setMaxCost(qsizetype cost)
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.setMaxCost(cost);
+}
+
+QByteArray ImageCache::key(const QImage &image)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const QSize size = image.size();
+    const int format = image.format();
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&size), sizeof(size)));
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&format), sizeof(format)));
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()));
+    return hash.result();
+}
+
+void ImageCache::ref(uint id, const QByteArray &key)
+{
+    auto it = m_keys.find(id);
+    if (it != m_keys.end()) {
+        if (*it == key) {
+            return;
+        }
+        const QByteArray oldKey = *it;
+        *it = key;
+        unref(oldKey);
+    } else {
+        m_keys.insert(id, key);
+    }
+
+    ++m_refs[key];
+}
+
+void ImageCache::unref(const QByteArray &key)
+{
+    auto it = m_refs.find(key);
+    if (it == m_refs.end()) {
+        return;
+    }
+
+    if (--(*it) > 0) {
+        return;
+    }
+
+    m_refs.erase(it);
+    m_images.remove(key);
+    // Still running decodes finish into the void
+    m_decoding.remove(key);
+}
+
+void ImageCache::finishDecoding(const QByteArray &key, quint64 serial, const QImage &image)
+{
+    if (const auto it = m_decoding.constFind(key); it != m_decoding.constEnd() && it->serial == serial) {
+        m_decoding.erase(it);
+    }
+    // Unless every notification let go of it in the meantime
+    if (m_refs.contains(key) && !m_images.contains(key)) {
+        store(key, image);
+    }
+}
+
+void ImageCache::store(const QByteArray &key, const QImage &image)
+{
+    if (!image.isNull()) {
+        m_images.insert(key, new QImage(image), image.width() * image.height());
+    }
+}
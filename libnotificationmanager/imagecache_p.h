@@ -0,0 +1,94 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+
+#include <functional>
+
+namespace NotificationManager
+{
+/**
+ * Images of notifications, stored once per content.
+ *
+ * Chat and media applications tend to send the same avatar or album art with
+ * many notifications. Images are keyed by a hash of their data and shared by all
+ * notifications referencing them, an image is dropped once none does anymore.
+ * The total size is still capped, the least recently used images go first.
+ *
+ * Decoded images are stored from the thread pool as soon as they're ready, so
+ * the cache is guarded by a mutex.
+ */
+class Q_DECL_HIDDEN ImageCache
+{
+public:
+    static ImageCache &self();
+
+    /**
+     * Whether the notification has an image, or one that is still being decoded.
+     */
+    bool contains(uint id) const;
+    QImage image(uint id);
+
+    /**
+     * Sets the image of the notification.
+     */
+    void insert(uint id, const QImage &image);
+    /**
+     * Sets the image of the notification to what @p decode produces.
+     *
+     * Unless an image with the given @p key is known already, @p decode is run
+     * on the thread pool. The returned future finishes once the image is available.
+     */
+    QFuture<QImage> insert(uint id, const QByteArray &key, std::function<QImage()> decode);
+    /**
+     * Same as above, for images whose @p key is too expensive to compute on the GUI thread.
+     *
+     * @p key is run on the thread pool, and @p decode only if no image with that key is
+     * known or being decoded already.
+     */
+    QFuture<QImage> insert(uint id, std::function<QByteArray()> key, std::function<QImage()> decode);
+
+    /**
+     * Drops the notification's reference to its image.
+     */
+    void remove(uint id);
+
+    void setMaxCost(qsizetype cost);
+
+    static QByteArray key(const QImage &image);
+
+private:
+    ImageCache() = default;
+
+    void ref(uint id, const QByteArray &key);
+    void unref(const QByteArray &key);
+    void store(const QByteArray &key, const QImage &image);
+    void finishDecoding(const QByteArray &key, quint64 serial, const QImage &image);
+
+    struct Decoding {
+        QFuture<QImage> future;
+        // Tells a decode apart from a later one of the same key
+        quint64 serial = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray /*key*/, QImage> m_images;
+    QHash<QByteArray /*key*/, Decoding> m_decoding;
+    QHash<QByteArray /*key*/, int> m_refs;
+    QHash<uint /*notificationId*/, QByteArray /*key*/> m_keys;
+    // Stands in for the key of an image while its key is computed
+    quint64 m_lastPlaceholder = 0;
+    quint64 m_lastDecoding = 0;
+};
+
+} // namespace NotificationManager
@@ -17,10 +17,13 @@
 
 #include <kio/global.h>
 
+#include <utility>
+
 #include "jobviewv2adaptor.h"
 #include "jobviewv3adaptor.h"
 
 using namespace NotificationManager;
+using namespace std::chrono_literals;
 
 JobPrivate::JobPrivate(uint id, QObject *parent)
     : QObject(parent)
@@ -29,6 +32,10 @@ JobPrivate::JobPrivate(uint id, QObject *parent)
     m_showTimer.setSingleShot(true);
     connect(&m_showTimer, &QTimer::timeout, this, &JobPrivate::requestShow);
 
+    m_changeTimer.setSingleShot(true);
+    m_changeTimer.setInterval(16ms);
+    connect(&m_changeTimer, &QTimer::timeout, this, &JobPrivate::emitChanges);
+
     m_objectPath.setPath(QStringLiteral("/org/kde/notificationmanager/jobs/JobView_%1").arg(id));
 
     // TODO also v1? it's identical to V2 except it doesn't have setError method so supporting it should be easy
@@ -48,6 +55,38 @@ void JobPrivate::requestShow()
     }
 }
 
+void JobPrivate::setUpdateInterval(std::chrono::milliseconds interval)
+{
+    m_changeTimer.setInterval(interval);
+}
+
+void JobPrivate::scheduleChange(void (Job::*changeSignal)())
+{
+    if (!m_pendingChanges.contains(changeSignal)) {
+        m_pendingChanges.append(changeSignal);
+    }
+
+    if (!m_changeTimer.isActive()) {
+        m_changeTimer.start();
+    }
+}
+
+void JobPrivate::emitChanges()
+{
+    m_changeTimer.stop();
+
+    Job *job = static_cast<Job *>(parent());
+
+    const QList<void (Job::*)()> changes = std::exchange(m_pendingChanges, {});
+    for (auto changeSignal : changes) {
+        Q_EMIT(job->*changeSignal)();
+    }
+
+    if (std::exchange(m_percentageChanged, false)) {
+        Q_EMIT job->percentageChanged(m_percentage);
+    }
+}
+
 QDBusObjectPath JobPrivate::objectPath() const
 {
     return m_objectPath;
@@ -368,7 +407,10 @@ void JobPrivate::setPercent(uint percent)
     const int percentage = static_cast<int>(percent);
     if (m_percentage != percentage) {
         m_percentage = percentage;
-        Q_EMIT static_cast<Job *>(parent())->percentageChanged(percentage);
+        m_percentageChanged = true;
+        if (!m_changeTimer.isActive()) {
+            m_changeTimer.start();
+        }
     }
 }
 
@@ -402,7 +444,7 @@ bool JobPrivate::setDescriptionField(uint number, const QString &name, const QSt
         dirty |= updateField(value, m_descriptionValue2, &Job::descriptionValue2Changed);
     }
     if (dirty) {
-        Q_EMIT static_cast<Job *>(parent())->descriptionUrlChanged();
+        scheduleChange(&Job::descriptionUrlChanged);
         updateHasDetails();
     }
 
@@ -436,6 +478,9 @@ void JobPrivate::terminate(uint errorCode, const QString &errorMessage, const QV
 {
     Q_UNUSED(hints) // reserved for future extension
 
+    // Everything reported so far should be out before the job stops
+    emitChanges();
+
     Job *job = static_cast<Job *>(parent());
     job->setError(errorCode);
     job->setErrorText(errorMessage);
@@ -45,6 +45,7 @@ public:
     QString text() const;
 
     void delayedShow(std::chrono::milliseconds delay, ShowConditions showConditions);
+    void setUpdateInterval(std::chrono::milliseconds interval);
     void kill();
 
     // DBus
@@ -88,12 +89,15 @@ private:
     {
         if (target != newValue) {
             target = newValue;
-            Q_EMIT((static_cast<Job *>(parent()))->*changeSignal)();
+            scheduleChange(changeSignal);
             return true;
         }
         return false;
     }
 
+    void scheduleChange(void (Job::*changeSignal)());
+    void emitChanges();
+
     template<typename T>
     bool updateFieldFromProperties(const QVariantMap &properties, const QString &keyName, T &target, void (Job::*changeSignal)())
     {
@@ -124,6 +128,12 @@ private:
 
     QTimer *m_killTimer = nullptr;
 
+    // Some jobs report progress hundreds of times a second, changes are
+    // gathered and signalled together at most once per update interval.
+    QTimer m_changeTimer;
+    QList<void (Job::*)()> m_pendingChanges;
+    bool m_percentageChanged = false;
+
     uint m_id = 0;
     QDBusObjectPath m_objectPath;
 
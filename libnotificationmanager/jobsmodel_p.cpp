@@ -250,6 +250,8 @@ QDBusObjectPath JobsModelPrivate::requestView(const QString &desktopEntry, int c
     Job *job = new Job(m_highestJobId);
     ++m_highestJobId;
 
+    job->d->setUpdateInterval(std::chrono::milliseconds(m_settings->jobUpdateInterval()));
+
     QString applicationName = hints.value(QStringLiteral("application-display-name")).toString();
     QString applicationIconName = hints.value(QStringLiteral("application-icon-name")).toString();
 
@@ -492,7 +494,10 @@ void JobsModelPrivate::onServiceUnregistered(const QString &serviceName)
 
 void JobsModelPrivate::scheduleUpdate(Job *job, int role)
 {
-    m_pendingDirtyRoles[job].append(role);
+    QList<int> &roles = m_pendingDirtyRoles[job];
+    if (!roles.contains(role)) {
+        roles.append(role);
+    }
     m_compressUpdatesTimer->start();
 }
 
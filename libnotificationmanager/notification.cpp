@@ -10,24 +10,151 @@
 #include "notification_p.h"
 
 #include <algorithm>
+#include <memory>
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDBusArgument>
 #include <QDebug>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QImageReader>
+#include <QPointer>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QXmlStreamReader>
 
 #include <KApplicationTrader>
 #include <KConfig>
 #include <KConfigGroup>
 #include <KService>
+#include <KSycoca>
 
 #include "debug.h"
+#include "imagecache_p.h"
 
 using namespace NotificationManager;
 using namespace Qt::StringLiterals;
 
-QCache<uint, QImage> Notification::Private::s_imageCache = QCache<uint, QImage>{};
+namespace
+{
+struct ServiceMetadata {
+    bool valid = false;
+    QString desktopEntryName;
+    QString name;
+    QString iconName;
+    bool configurable = false;
+};
+
+struct NotifyRcMetadata {
+    QString iconName;
+    bool configurable = false;
+};
+
+// Applications tend to send many notifications, looking up their service and
+// parsing their notifyrc every time is wasteful. What we found, or didn't find,
+// is kept until the service database or the installed notifyrc files change.
+class ComponentMetadataCache
+{
+public:
+    static ComponentMetadataCache &self()
+    {
+        static ComponentMetadataCache s_self;
+        return s_self;
+    }
+
+    ServiceMetadata service(const QString &desktopEntry)
+    {
+        auto it = m_services.constFind(desktopEntry);
+        if (it == m_services.constEnd()) {
+            ServiceMetadata metadata;
+            if (KService::Ptr service = Notification::Private::serviceForDesktopEntry(desktopEntry)) {
+                metadata.valid = true;
+                metadata.desktopEntryName = service->desktopEntryName();
+                metadata.name = service->name();
+                metadata.iconName = service->icon();
+                metadata.configurable = !service->noDisplay();
+            }
+            it = m_services.insert(desktopEntry, metadata);
+        }
+        return *it;
+    }
+
+    NotifyRcMetadata notifyRc(const QString &notifyRcName)
+    {
+        auto it = m_notifyRcs.constFind(notifyRcName);
+        if (it == m_notifyRcs.constEnd()) {
+            it = m_notifyRcs.insert(notifyRcName, readNotifyRc(notifyRcName));
+        }
+        return *it;
+    }
+
+private:
+    ComponentMetadataCache()
+    {
+        auto clear = [this] {
+            m_services.clear();
+            m_notifyRcs.clear();
+            watchNotifyRcDirs();
+        };
+
+        if (auto app = QCoreApplication::instance()) {
+            m_watcher = new QFileSystemWatcher(app);
+            QObject::connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_watcher, clear);
+            QObject::connect(KSycoca::self(), &KSycoca::databaseChanged, m_watcher, clear);
+            watchNotifyRcDirs();
+        }
+    }
+
+    void watchNotifyRcDirs()
+    {
+        if (!m_watcher) {
+            return;
+        }
+
+        // New directories only show up with new applications, which also changes the service database
+        for (const QString &dirName : {u"knotifications6"_s, u"knotifications5"_s}) {
+            const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, dirName, QStandardPaths::LocateDirectory);
+            for (const QString &dir : dirs) {
+                if (!m_watcher->directories().contains(dir)) {
+                    m_watcher->addPath(dir);
+                }
+            }
+        }
+    }
+
+    static NotifyRcMetadata readNotifyRc(const QString &notifyRcName)
+    {
+        NotifyRcMetadata metadata;
+
+        // Check whether the application actually has notifications we can configure
+        KConfig config(notifyRcName + QStringLiteral(".notifyrc"), KConfig::NoGlobals);
+
+        QStringList configSources =
+            QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("knotifications6/%1.notifyrc").arg(notifyRcName));
+        // Keep compatibility with KF5 applications
+        if (configSources.isEmpty()) {
+            configSources = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("knotifications5/%1.notifyrc").arg(notifyRcName));
+        }
+        // `QStandardPaths` follows the order of precedence given by `$XDG_DATA_DIRS
+        // (more priority goest first), but for `addConfigSources() it is the opposite
+        std::reverse(configSources.begin(), configSources.end());
+        config.addConfigSources(configSources);
+
+        KConfigGroup globalGroup(&config, u"Global"_s);
+        metadata.iconName = globalGroup.readEntry("IconName");
+
+        static const QRegularExpression regexp(QStringLiteral("^Event/([^/]*)$"));
+        metadata.configurable = !config.groupList().filter(regexp).isEmpty();
+
+        return metadata;
+    }
+
+    QHash<QString /*desktop entry*/, ServiceMetadata> m_services;
+    QHash<QString /*notifyrc name*/, NotifyRcMetadata> m_notifyRcs;
+    QPointer<QFileSystemWatcher> m_watcher;
+};
+}
 
 Notification::Private::Private()
 {
@@ -137,34 +264,42 @@ QString Notification::Private::sanitize(const QString &text)
     return result;
 }
 
-QImage Notification::Private::decodeNotificationSpecImageHint(const QDBusArgument &arg)
+std::optional<Notification::Private::ImageHint> Notification::Private::readNotificationSpecImageHint(const QDBusArgument &arg)
 {
-    int width, height, rowStride, hasAlpha, bitsPerSample, channels;
-    QByteArray pixels;
-    char *ptr;
-    char *end;
+    ImageHint hint;
 
     if (arg.currentType() != QDBusArgument::StructureType) {
-        return QImage();
+        return std::nullopt;
     }
     arg.beginStructure();
-    arg >> width >> height >> rowStride >> hasAlpha >> bitsPerSample >> channels >> pixels;
+    arg >> hint.width >> hint.height >> hint.rowStride >> hint.hasAlpha >> hint.bitsPerSample >> hint.channels >> hint.pixels;
     arg.endStructure();
 
 #define SANITY_CHECK(condition)                                                                                                                                \
     if (!(condition)) {                                                                                                                                        \
         qCWarning(NOTIFICATIONMANAGER) << "Image decoding sanity check failed on" << #condition;                                                               \
-        return QImage();                                                                                                                                       \
+        return std::nullopt;                                                                                                                                   \
     }
 
-    SANITY_CHECK(width > 0);
-    SANITY_CHECK(width < 2048);
-    SANITY_CHECK(height > 0);
-    SANITY_CHECK(height < 2048);
-    SANITY_CHECK(rowStride > 0);
+    SANITY_CHECK(hint.width > 0);
+    SANITY_CHECK(hint.width < 2048);
+    SANITY_CHECK(hint.height > 0);
+    SANITY_CHECK(hint.height < 2048);
+    SANITY_CHECK(hint.rowStride > 0);
 
 #undef SANITY_CHECK
 
+    if (hint.bitsPerSample != 8 || (hint.channels != 4 && hint.channels != 3)) {
+        qCWarning(NOTIFICATIONMANAGER) << "Unsupported image format (hasAlpha:" << hint.hasAlpha << "bitsPerSample:" << hint.bitsPerSample
+                                       << "channels:" << hint.channels << ")";
+        return std::nullopt;
+    }
+
+    return hint;
+}
+
+QImage Notification::Private::decodeNotificationSpecImageHint(const ImageHint &hint)
+{
     auto copyLineRGB32 = [](QRgb *dst, const char *src, int width) {
         const char *end = src + width * 3;
         for (; src != end; ++dst, src += 3) {
@@ -179,32 +314,22 @@ QImage Notification::Private::decodeNotificationSpecImageHint(const QDBusArgumen
         }
     };
 
-    QImage::Format format = QImage::Format_Invalid;
-    void (*fcn)(QRgb *, const char *, int) = nullptr;
-    if (bitsPerSample == 8) {
-        if (channels == 4) {
-            format = QImage::Format_ARGB32;
-            fcn = copyLineARGB32;
-        } else if (channels == 3) {
-            format = QImage::Format_RGB32;
-            fcn = copyLineRGB32;
-        }
-    }
-    if (format == QImage::Format_Invalid) {
-        qCWarning(NOTIFICATIONMANAGER) << "Unsupported image format (hasAlpha:" << hasAlpha << "bitsPerSample:" << bitsPerSample << "channels:" << channels
-                                       << ")";
-        return QImage();
+    QImage::Format format = QImage::Format_ARGB32;
+    void (*fcn)(QRgb *, const char *, int) = copyLineARGB32;
+    if (hint.channels == 3) {
+        format = QImage::Format_RGB32;
+        fcn = copyLineRGB32;
     }
 
-    QImage image(width, height, format);
-    ptr = pixels.data();
-    end = ptr + pixels.length();
-    for (int y = 0; y < height; ++y, ptr += rowStride) {
-        if (ptr + channels * width > end) {
-            qCWarning(NOTIFICATIONMANAGER) << "Image data is incomplete. y:" << y << "height:" << height;
+    QImage image(hint.width, hint.height, format);
+    const char *ptr = hint.pixels.constData();
+    const char *end = ptr + hint.pixels.length();
+    for (int y = 0; y < hint.height; ++y, ptr += hint.rowStride) {
+        if (ptr + hint.channels * hint.width > end) {
+            qCWarning(NOTIFICATIONMANAGER) << "Image data is incomplete. y:" << y << "height:" << hint.height;
             break;
         }
-        fcn((QRgb *)image.scanLine(y), ptr, width);
+        fcn((QRgb *)image.scanLine(y), ptr, hint.width);
     }
 
     return image;
@@ -227,7 +352,8 @@ void Notification::Private::loadImagePath(const QString &path)
     // image_path and appIcon should either be a URL with file scheme or the name of a themed icon.
     // We're lenient and also allow local paths.
 
-    s_imageCache.remove(id); // clear
+    ImageCache::self().remove(id); // clear
+    imageDecoding = QFuture<QImage>();
     icon.clear();
 
     QUrl imageUrl;
@@ -248,16 +374,29 @@ void Notification::Private::loadImagePath(const QString &path)
         return;
     }
 
-    QImageReader reader(imageUrl.toLocalFile());
-    reader.setAutoTransform(true);
+    const QFileInfo fileInfo(imageUrl.toLocalFile());
+    if (!fileInfo.isFile()) {
+        return;
+    }
+
+    const QByteArray key = QCryptographicHash::hash((fileInfo.absoluteFilePath() + fileInfo.lastModified().toString(Qt::ISODateWithMs)).toUtf8(),
+                                                    QCryptographicHash::Sha1);
+
+    imageDecoding = ImageCache::self().insert(id, key, [path = fileInfo.absoluteFilePath()] {
+        QImageReader reader(path);
+        reader.setAutoTransform(true);
+
+        QSize imageSize = reader.size();
+        if (!imageSize.isValid()) {
+            return QImage();
+        }
 
-    if (QSize imageSize = reader.size(); imageSize.isValid()) {
         if (imageSize.width() > maximumImageSize().width() || imageSize.height() > maximumImageSize().height()) {
             imageSize = imageSize.scaled(maximumImageSize(), Qt::KeepAspectRatio);
             reader.setScaledSize(imageSize);
         }
-        s_imageCache.insert(id, new QImage(reader.read()), imageSize.width() * imageSize.height());
-    }
+        return reader.read();
+    });
 }
 
 QString Notification::Private::defaultComponentName()
@@ -325,42 +464,27 @@ void Notification::Private::setDesktopEntry(const QString &desktopEntry)
 
     configurableService = false;
 
-    KService::Ptr service = serviceForDesktopEntry(desktopEntry);
-    if (service) {
-        this->desktopEntry = service->desktopEntryName();
-        serviceName = service->name();
-        applicationIconName = service->icon();
-        configurableService = !service->noDisplay();
+    if (!desktopEntry.isEmpty()) {
+        const ServiceMetadata service = ComponentMetadataCache::self().service(desktopEntry);
+        if (service.valid) {
+            this->desktopEntry = service.desktopEntryName;
+            serviceName = service.name;
+            applicationIconName = service.iconName;
+            configurableService = service.configurable;
+        }
     }
 
     const bool isDefaultEvent = (notifyRcName == defaultComponentName());
     configurableNotifyRc = false;
     if (!notifyRcName.isEmpty()) {
-        // Check whether the application actually has notifications we can configure
-        KConfig config(notifyRcName + QStringLiteral(".notifyrc"), KConfig::NoGlobals);
-
-        QStringList configSources =
-            QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("knotifications6/%1.notifyrc").arg(notifyRcName));
-        // Keep compatibility with KF5 applications
-        if (configSources.isEmpty()) {
-            configSources = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("knotifications5/%1.notifyrc").arg(notifyRcName));
-        }
-        // `QStandardPaths` follows the order of precedence given by `$XDG_DATA_DIRS
-        // (more priority goest first), but for `addConfigSources() it is the opposite
-        std::reverse(configSources.begin(), configSources.end());
-        config.addConfigSources(configSources);
-
-        KConfigGroup globalGroup(&config, u"Global"_s);
-
-        const QString iconName = globalGroup.readEntry("IconName");
+        const NotifyRcMetadata notifyRc = ComponentMetadataCache::self().notifyRc(notifyRcName);
 
         // also only overwrite application icon name for non-default events (or if we don't have a service icon)
-        if (!iconName.isEmpty() && (!isDefaultEvent || applicationIconName.isEmpty())) {
-            applicationIconName = iconName;
+        if (!notifyRc.iconName.isEmpty() && (!isDefaultEvent || applicationIconName.isEmpty())) {
+            applicationIconName = notifyRc.iconName;
         }
 
-        const QRegularExpression regexp(QStringLiteral("^Event/([^/]*)$"));
-        configurableNotifyRc = !config.groupList().filter(regexp).isEmpty();
+        configurableNotifyRc = notifyRc.configurable;
     }
 
     // For default events we try to show the application name from the desktop entry if possible
@@ -439,20 +563,32 @@ void Notification::Private::processHints(const QVariantMap &hints)
         it = hints.find(QStringLiteral("icon_data"));
     }
 
-    QImage *image = nullptr;
+    bool hasImage = false;
     if (it != end) {
-        QImage imageFromHint(decodeNotificationSpecImageHint(it->value<QDBusArgument>()));
-        if (!imageFromHint.isNull()) {
-            Q_ASSERT_X(imageFromHint.width() > 0 && imageFromHint.height() > 0,
-                       Q_FUNC_INFO,
-                       qPrintable(QStringLiteral("%1 %2").arg(QString::number(imageFromHint.width()), QString::number(imageFromHint.height()))));
-            sanitizeImage(imageFromHint);
-            image = new QImage(imageFromHint);
-            s_imageCache.insert(id, image, imageFromHint.width() * imageFromHint.height());
+        if (std::optional<ImageHint> imageHint = readNotificationSpecImageHint(it->value<QDBusArgument>())) {
+            // Identical images, e.g. the same avatar for every chat message, are decoded and stored only once.
+            // Hashing the pixels takes about as long as decoding them, so it's done on the thread pool too.
+            auto hint = std::make_shared<const ImageHint>(std::move(*imageHint));
+            imageDecoding = ImageCache::self().insert(
+                id,
+                [hint] {
+                    QCryptographicHash hash(QCryptographicHash::Sha1);
+                    for (int value : {hint->width, hint->height, hint->rowStride, hint->hasAlpha, hint->bitsPerSample, hint->channels}) {
+                        hash.addData(QByteArrayView(reinterpret_cast<const char *>(&value), sizeof(value)));
+                    }
+                    hash.addData(hint->pixels);
+                    return hash.result();
+                },
+                [hint] {
+                    QImage image = decodeNotificationSpecImageHint(*hint);
+                    sanitizeImage(image);
+                    return image;
+                });
+            hasImage = true;
         }
     }
 
-    if (!image) {
+    if (!hasImage) {
         it = hints.find(QStringLiteral("image-path"));
         if (it == end) {
             it = hints.find(QStringLiteral("image_path"));
@@ -599,19 +735,18 @@ QString Notification::icon() const
 void Notification::setIcon(const QString &icon)
 {
     d->loadImagePath(icon);
+    d->imageDecoding.waitForFinished();
 }
 
 QImage Notification::image() const
 {
-    if (d->s_imageCache.contains(d->id)) {
-        return *d->s_imageCache.object(d->id);
-    }
-    return QImage();
+    return ImageCache::self().image(d->id);
 }
 
 void Notification::setImage(const QImage &image)
 {
-    d->s_imageCache.insert(d->id, new QImage(image));
+    ImageCache::self().insert(d->id, image);
+    d->imageDecoding = QFuture<QImage>();
 }
 
 QString Notification::desktopEntry() const
@@ -852,6 +987,7 @@ void Notification::setHints(const QVariantMap &hints)
 void Notification::processHints(const QVariantMap &hints)
 {
     d->processHints(hints);
+    d->imageDecoding.waitForFinished();
 }
 
 bool Notification::wasAddedDuringInhibition() const
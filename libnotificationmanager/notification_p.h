@@ -6,14 +6,16 @@
 
 #pragma once
 
-#include <QCache>
 #include <QDBusArgument>
 #include <QDateTime>
+#include <QFuture>
 #include <QImage>
 #include <QUrl>
 
 #include <KService>
 
+#include <optional>
+
 #include "notifications.h"
 
 namespace NotificationManager
@@ -25,7 +27,19 @@ public:
     ~Private();
 
     static QString sanitize(const QString &text);
-    static QImage decodeNotificationSpecImageHint(const QDBusArgument &arg);
+
+    // The raw pixels of an image-data hint, to be decoded off the GUI thread
+    struct ImageHint {
+        int width = 0;
+        int height = 0;
+        int rowStride = 0;
+        int hasAlpha = 0;
+        int bitsPerSample = 0;
+        int channels = 0;
+        QByteArray pixels;
+    };
+    static std::optional<ImageHint> readNotificationSpecImageHint(const QDBusArgument &arg);
+    static QImage decodeNotificationSpecImageHint(const ImageHint &hint);
     static void sanitizeImage(QImage &image);
 
     void loadImagePath(const QString &path);
@@ -53,7 +67,8 @@ public:
     QString rawBody;
     // Can be theme icon name or path
     QString icon;
-    static QCache<uint /*id*/, QImage> s_imageCache;
+    // Finishes once the image is in the ImageCache
+    QFuture<QImage> imageDecoding;
 
     QString applicationName;
     QString desktopEntry;
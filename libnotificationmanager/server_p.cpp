@@ -11,6 +11,7 @@
 #include "notificationmanageradaptor.h"
 #include "notificationsadaptor.h"
 
+#include "imagecache_p.h"
 #include "notification_p.h"
 
 #include "server.h"
@@ -19,7 +20,12 @@
 #include "utils_p.h"
 
 #include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDBusServiceWatcher>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 
 #include <KConfigGroup>
 #include <KService>
@@ -32,6 +38,7 @@ ServerPrivate::ServerPrivate(QObject *parent)
     : QObject(parent)
     , m_inhibitionWatcher(new QDBusServiceWatcher(this))
     , m_notificationWatchers(new QDBusServiceWatcher(this))
+    , m_senderWatcher(new QDBusServiceWatcher(this))
 {
     m_inhibitionWatcher->setConnection(QDBusConnection::sessionBus());
     m_inhibitionWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
@@ -42,6 +49,14 @@ ServerPrivate::ServerPrivate(QObject *parent)
     connect(m_notificationWatchers, &QDBusServiceWatcher::serviceUnregistered, [this](const QString &service) {
         m_notificationWatchers->removeWatchedService(service);
     });
+
+    // Unique names are never reused, once one is gone its process is of no interest anymore
+    m_senderWatcher->setConnection(QDBusConnection::sessionBus());
+    m_senderWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_senderWatcher, &QDBusServiceWatcher::serviceUnregistered, this, [this](const QString &service) {
+        m_senderWatcher->removeWatchedService(service);
+        m_senders.remove(service);
+    });
 }
 
 ServerPrivate::~ServerPrivate() = default;
@@ -125,7 +140,7 @@ bool ServerPrivate::init()
                                              SLOT(onBroadcastNotification(QMap<QString, QVariant>)));
     }
 
-    Notification::Private::s_imageCache.setMaxCost(256 * 256 * 100);
+    ImageCache::self().setMaxCost(256 * 256 * 100);
 
     m_valid = true;
     Q_EMIT validChanged();
@@ -155,8 +170,10 @@ uint ServerPrivate::Notify(const QString &app_name,
         ++m_highestNotificationId;
     }
 
+    const QString dbusService = message().service();
+
     Notification notification(notificationId);
-    notification.setDBusService(message().service());
+    notification.setDBusService(dbusService);
     notification.setSummary(summary);
     notification.setBody(body);
     notification.setApplicationName(app_name);
@@ -172,52 +189,181 @@ uint ServerPrivate::Notify(const QString &app_name,
     // If we got a pixmap, use app_icon as application icon,
     // otherwise use it as the notification icon.
     if (!app_icon.isEmpty()) {
-        if (notification.d->s_imageCache.contains(notificationId)) {
+        if (ImageCache::self().contains(notificationId)) {
             notification.setApplicationIconName(app_icon);
         } else {
-            notification.setIcon(app_icon);
+            notification.d->loadImagePath(app_icon);
         }
     }
 
-    uint pid = 0;
-    if (notification.desktopEntry().isEmpty() || notification.applicationName().isEmpty()) {
+    if (needsSender(notification)) {
         if (notification.desktopEntry().isEmpty() && notification.applicationName().isEmpty()) {
-            qCInfo(NOTIFICATIONMANAGER) << "Notification from service" << message().service()
+            qCInfo(NOTIFICATIONMANAGER) << "Notification from service" << dbusService
                                         << "didn't contain any identification information. This is a bug in the application" << app_name;
         }
-        QDBusReply<uint> pidReply = connection().interface()->servicePid(message().service());
-        if (pidReply.isValid()) {
-            pid = pidReply.value();
+
+        if (const auto it = m_senders.constFind(dbusService); it != m_senders.constEnd()) {
+            applySender(notification, *it);
+        } else if (!dbusService.isEmpty() && !m_resolvingSenders.contains(dbusService)) {
+            m_resolvingSenders.insert(dbusService);
+            resolveSender(dbusService);
+        }
+    }
+
+    // Hold it back until its sender and image are known, keeping the order in which a sender's notifications arrived
+    const bool imageDecoding = !notification.d->imageDecoding.isFinished();
+    if (imageDecoding || m_resolvingSenders.contains(dbusService) || m_pendingNotifications.contains(dbusService)) {
+        QDBusMessage call;
+        if (calledFromDBus() && message().type() == QDBusMessage::MethodCallMessage) {
+            setDelayedReply(true);
+            call = message();
+        }
+        m_pendingNotifications[dbusService].append({notification, replaces_id, actions, hints, call});
+
+        if (imageDecoding) {
+            auto *watcher = new QFutureWatcher<QImage>(this);
+            connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, dbusService] {
+                watcher->deleteLater();
+                flushPendingNotifications(dbusService);
+            });
+            watcher->setFuture(notification.d->imageDecoding);
         }
+
+        return notificationId;
+    }
+
+    if (!publish(notification, replaces_id, actions, hints)) {
+        sendErrorReply(QStringLiteral("org.freedesktop.Notifications.Error.ExcessNotificationGeneration"),
+                       QStringLiteral("Created too many similar notifications in quick succession"));
+        return 0;
     }
 
+    return notificationId;
+}
+
+bool ServerPrivate::needsSender(const Notification &notification)
+{
+    return notification.desktopEntry().isEmpty() || notification.applicationName().isEmpty();
+}
+
+void ServerPrivate::applySender(Notification &notification, const SenderInfo &sender)
+{
     // No desktop entry? Try to read the BAMF_DESKTOP_FILE_HINT in the environment of snaps
-    if (notification.desktopEntry().isEmpty() && pid > 0) {
-        const QString desktopEntry = Utils::desktopEntryFromPid(pid);
-        if (!desktopEntry.isEmpty()) {
-            qCDebug(NOTIFICATIONMANAGER) << "Resolved notification to be from desktop entry" << desktopEntry;
-            notification.setDesktopEntry(desktopEntry);
-
-            // No application name? Set it to the service name, which is nicer than the process name fallback below
-            // Also if the title looks like it's just the desktop entry, use the nicer service name
-            if (notification.applicationName().isEmpty() || notification.applicationName() == desktopEntry) {
-                KService::Ptr service = KService::serviceByDesktopName(desktopEntry);
-                if (service) {
-                    notification.setApplicationName(service->name());
-                }
-            }
+    if (notification.desktopEntry().isEmpty() && !sender.desktopEntry.isEmpty()) {
+        qCDebug(NOTIFICATIONMANAGER) << "Resolved notification to be from desktop entry" << sender.desktopEntry;
+        notification.setDesktopEntry(sender.desktopEntry);
+
+        // No application name? Set it to the service name, which is nicer than the process name fallback below
+        // Also if the title looks like it's just the desktop entry, use the nicer service name
+        if (!sender.serviceName.isEmpty() && (notification.applicationName().isEmpty() || notification.applicationName() == sender.desktopEntry)) {
+            notification.setApplicationName(sender.serviceName);
         }
     }
 
     // No application name? Try to figure out the process name using the sender's PID
-    if (notification.applicationName().isEmpty() && pid > 0) {
-        const QString processName = Utils::processNameFromPid(pid);
-        if (!processName.isEmpty()) {
-            qCDebug(NOTIFICATIONMANAGER) << "Resolved notification to be from process name" << processName;
-            notification.setApplicationName(processName);
+    if (notification.applicationName().isEmpty() && !sender.processName.isEmpty()) {
+        qCDebug(NOTIFICATIONMANAGER) << "Resolved notification to be from process name" << sender.processName;
+        notification.setApplicationName(sender.processName);
+    }
+}
+
+void ServerPrivate::resolveSender(const QString &dbusService)
+{
+    m_senderWatcher->addWatchedService(dbusService);
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    auto *watcher = new QDBusPendingCallWatcher(bus->asyncCall(QStringLiteral("GetConnectionUnixProcessID"), dbusService), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, dbusService](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+
+        const QDBusPendingReply<uint> reply = *watcher;
+        if (reply.isError()) {
+            qCDebug(NOTIFICATIONMANAGER) << "Failed to determine PID of notification sender" << dbusService << reply.error().message();
+            onSenderResolved(dbusService, SenderInfo{});
+            return;
+        }
+
+        const uint pid = reply.value();
+
+        auto *futureWatcher = new QFutureWatcher<SenderInfo>(this);
+        connect(futureWatcher, &QFutureWatcherBase::finished, this, [this, dbusService, futureWatcher] {
+            futureWatcher->deleteLater();
+            onSenderResolved(dbusService, futureWatcher->result());
+        });
+        futureWatcher->setFuture(QtConcurrent::run([pid] {
+            SenderInfo sender;
+            sender.pid = pid;
+            sender.desktopEntry = Utils::desktopEntryFromPid(pid);
+            sender.processName = Utils::processNameFromPid(pid);
+            return sender;
+        }));
+    });
+}
+
+void ServerPrivate::onSenderResolved(const QString &dbusService, SenderInfo sender)
+{
+    if (!sender.desktopEntry.isEmpty()) {
+        KService::Ptr service = KService::serviceByDesktopName(sender.desktopEntry);
+        if (service) {
+            sender.serviceName = service->name();
         }
     }
 
+    // Don't remember a sender that's gone already, or that we couldn't look up at all
+    if (sender.pid > 0 && m_senderWatcher->watchedServices().contains(dbusService)) {
+        m_senders.insert(dbusService, sender);
+    } else {
+        m_senderWatcher->removeWatchedService(dbusService);
+    }
+
+    m_resolvingSenders.remove(dbusService);
+
+    if (const auto it = m_pendingNotifications.find(dbusService); it != m_pendingNotifications.end()) {
+        for (PendingNotification &pending : *it) {
+            applySender(pending.notification, sender);
+        }
+    }
+
+    flushPendingNotifications(dbusService);
+}
+
+void ServerPrivate::flushPendingNotifications(const QString &dbusService)
+{
+    if (m_resolvingSenders.contains(dbusService)) {
+        return;
+    }
+
+    for (auto it = m_pendingNotifications.find(dbusService); it != m_pendingNotifications.end(); it = m_pendingNotifications.find(dbusService)) {
+        if (it->isEmpty()) {
+            m_pendingNotifications.erase(it);
+            return;
+        }
+
+        if (!it->constFirst().notification.d->imageDecoding.isFinished()) {
+            return;
+        }
+
+        const PendingNotification pending = it->takeFirst();
+        sendPendingReply(pending, publish(pending.notification, pending.replacesId, pending.actions, pending.hints));
+    }
+}
+
+void ServerPrivate::sendPendingReply(const PendingNotification &pending, bool published)
+{
+    if (pending.call.type() != QDBusMessage::MethodCallMessage) {
+        return;
+    }
+    if (published) {
+        QDBusConnection::sessionBus().send(pending.call.createReply(pending.notification.id()));
+    } else {
+        QDBusConnection::sessionBus().send(
+            pending.call.createErrorReply(QStringLiteral("org.freedesktop.Notifications.Error.ExcessNotificationGeneration"),
+                                          QStringLiteral("Created too many similar notifications in quick succession")));
+    }
+}
+
+bool ServerPrivate::publish(Notification notification, uint replacesId, const QStringList &actions, const QVariantMap &hints)
+{
     // If multiple identical notifications are sent in quick succession, refuse the request
     if (m_lastNotification.applicationName() == notification.applicationName() && m_lastNotification.summary() == notification.summary()
         && m_lastNotification.body() == notification.body() && m_lastNotification.desktopEntry() == notification.desktopEntry()
@@ -225,17 +371,14 @@ uint ServerPrivate::Notify(const QString &app_name,
         && m_lastNotification.icon() == notification.icon() && m_lastNotification.urls() == notification.urls()
         && m_lastNotification.created().msecsTo(notification.created()) < 1000) {
         qCDebug(NOTIFICATIONMANAGER) << "Discarding excess notification creation request";
-
-        sendErrorReply(QStringLiteral("org.freedesktop.Notifications.Error.ExcessNotificationGeneration"),
-                       QStringLiteral("Created too many similar notifications in quick succession"));
-        return 0;
+        return false;
     }
 
     m_lastNotification = notification;
 
-    if (wasReplaced) {
+    if (replacesId > 0) {
         notification.resetUpdated();
-        Q_EMIT static_cast<Server *>(parent())->notificationReplaced(replaces_id, notification);
+        Q_EMIT static_cast<Server *>(parent())->notificationReplaced(replacesId, notification);
     } else {
         Q_EMIT static_cast<Server *>(parent())->notificationAdded(notification);
     }
@@ -247,9 +390,9 @@ uint ServerPrivate::Notify(const QString &app_name,
                                                           QStringLiteral("/NotificationWatcher"),
                                                           QStringLiteral("org.kde.NotificationWatcher"),
                                                           QStringLiteral("Notify"));
-        msg.setArguments({notificationId,
+        msg.setArguments({notification.id(),
                           notification.applicationName(),
-                          replaces_id,
+                          replacesId,
                           notification.applicationIconName(),
                           notification.summary(),
                           // we pass raw body data since this data goes through another sanitization
@@ -261,11 +404,30 @@ uint ServerPrivate::Notify(const QString &app_name,
         QDBusConnection::sessionBus().call(msg, QDBus::NoBlock);
     }
 
-    return notificationId;
+    return true;
 }
 
 void ServerPrivate::CloseNotification(uint id)
 {
+    // It might not have made it out yet
+    QStringList unblockedServices;
+    for (auto it = m_pendingNotifications.begin(); it != m_pendingNotifications.end(); ++it) {
+        if (it->removeIf([id](const PendingNotification &pending) {
+                if (pending.notification.id() != id) {
+                    return false;
+                }
+                // Closed before it was shown, the sender still gets its id
+                sendPendingReply(pending, true);
+                return true;
+            })) {
+            unblockedServices.append(it.key());
+        }
+    }
+    // What came after it might be good to go now
+    for (const QString &service : std::as_const(unblockedServices)) {
+        flushPendingNotifications(service);
+    }
+
     for (const QString &service : m_notificationWatchers->watchedServices()) {
         QDBusMessage msg = QDBusMessage::createMethodCall(service,
                                                           QStringLiteral("/NotificationWatcher"),
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <QDBusContext>
+#include <QDBusMessage>
 #include <QObject>
 #include <QSet>
 #include <QStringList>
@@ -24,6 +25,14 @@ struct Inhibition {
     QVariantMap hints;
 };
 
+// What we could find out about the process behind a D-Bus unique name
+struct SenderInfo {
+    uint pid = 0;
+    QString desktopEntry;
+    QString serviceName; // name of the desktopEntry's service
+    QString processName;
+};
+
 namespace NotificationManager
 {
 class ServerInfo;
@@ -114,6 +123,13 @@ private:
     void onInhibitionServiceUnregistered(const QString &serviceName);
     void onInhibitedChanged(); // Q_EMIT DBus change signal
 
+    bool publish(Notification notification, uint replacesId, const QStringList &actions, const QVariantMap &hints);
+    static bool needsSender(const Notification &notification);
+    static void applySender(Notification &notification, const SenderInfo &sender);
+    void resolveSender(const QString &dbusService);
+    void onSenderResolved(const QString &dbusService, SenderInfo sender);
+    void flushPendingNotifications(const QString &dbusService);
+
     bool m_dbusObjectValid = false;
 
     mutable std::unique_ptr<ServerInfo> m_currentOwner;
@@ -124,6 +140,25 @@ private:
     QHash<uint /*cookie*/, Inhibition> m_externalInhibitions;
     QHash<uint /*cookie*/, QString> m_inhibitionServices;
 
+    struct PendingNotification {
+        Notification notification;
+        uint replacesId = 0;
+        QStringList actions;
+        QVariantMap hints;
+        // The Notify call, answered once the notification is published. Until then the
+        // sender waits for its id, which keeps short-lived senders around to be resolved.
+        QDBusMessage call;
+    };
+    static void sendPendingReply(const PendingNotification &pending, bool published);
+
+    // Resolving a sender involves a bus round-trip and poking around in /proc,
+    // so it's done once per unique name and off the GUI thread.
+    QDBusServiceWatcher *const m_senderWatcher;
+    QHash<QString /*unique name*/, SenderInfo> m_senders;
+    QSet<QString /*unique name*/> m_resolvingSenders;
+    // Notifications held back until their sender is resolved and their image decoded, in the order they came in
+    QHash<QString /*unique name*/, QList<PendingNotification>> m_pendingNotifications;
+
     bool m_inhibited = false;
 
     Notification m_lastNotification;
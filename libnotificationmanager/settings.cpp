@@ -455,6 +455,11 @@ void Settings::setPermanentJobPopups(bool enable)
     d->setDirty(true);
 }
 
+int Settings::jobUpdateInterval() const
+{
+    return d->jobSettings.updateInterval();
+}
+
 bool Settings::badgesInTaskManager() const
 {
     return d->badgeSettings.inTaskManager();
@@ -285,6 +285,14 @@ public:
     bool permanentJobPopups() const;
     void setPermanentJobPopups(bool enable);
 
+    /**
+     * How often, in milliseconds, the progress of a job is updated at most.
+     * Jobs can report progress far more often than it can be shown.
+     * Default is 16ms, about once per frame.
+     * @since 6.6
+     */
+    int jobUpdateInterval() const;
+
     bool badgesInTaskManager() const;
     void setBadgesInTaskManager(bool enable);
 
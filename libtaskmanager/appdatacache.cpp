@@ -0,0 +1,190 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "appdatacache.h"
+#include "tasktools_p.h"
+
+#include <KDirWatch>
+#include <KService>
+#include <KSycoca>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+namespace TaskManager
+{
+namespace
+{
+// Entries, not bytes. Many more than the processes a session usually runs windows of.
+constexpr qsizetype s_maxWindowUrls = 512;
+constexpr qsizetype s_maxAppData = 256;
+
+/**
+ * Identifies the process for windowUrlFromMetadata(), which may look at the command
+ * line and the environment of the process. Both are fixed once it runs, so the pid
+ * together with the start time of the process, which tells a reused pid apart, is
+ * enough. Reading it is a single small read of /proc/<pid>/stat.
+ */
+QString processKey(quint32 pid)
+{
+    if (pid == 0) {
+        return QString();
+    }
+
+    QFile stat(u"/proc/%1/stat"_s.arg(pid));
+    if (stat.open(QIODevice::ReadOnly)) {
+        const QByteArray data = stat.readAll();
+        // The command name in field 2 is in parentheses and may contain anything,
+        // the start time is field 22.
+        const qsizetype commEnd = data.lastIndexOf(')');
+        if (commEnd >= 0) {
+            const QList<QByteArray> fields = data.mid(commEnd + 1).simplified().split(' ');
+            if (fields.size() > 19) {
+                return QString::number(pid) + u'@' + QString::fromLatin1(fields.at(19));
+            }
+        }
+    }
+
+    // Without procfs only windows of the same process share the result.
+    return QString::number(pid);
+}
+}
+
+AppDataCache::AppDataCache()
+    : m_rulesConfig(KSharedConfig::openConfig(u"taskmanagerrulesrc"_s))
+    , m_configWatcher(new KDirWatch(this))
+    , m_windowUrls(s_maxWindowUrls)
+    , m_appData(s_maxAppData)
+{
+    m_sycocaChangeTimer.setSingleShot(true);
+    m_sycocaChangeTimer.setInterval(100ms);
+    connect(&m_sycocaChangeTimer, &QTimer::timeout, this, &AppDataCache::sycocaChanged);
+    connect(KSycoca::self(), &KSycoca::databaseChanged, this, [this] {
+        m_sycocaChangeTimer.start();
+    });
+
+    for (const auto locations = QStandardPaths::standardLocations(QStandardPaths::ConfigLocation); const QString &location : locations) {
+        m_configWatcher->addFile(location + QLatin1String("/taskmanagerrulesrc"));
+    }
+
+    connect(m_configWatcher, &KDirWatch::dirty, this, &AppDataCache::rulesConfigChanged);
+    connect(m_configWatcher, &KDirWatch::created, this, &AppDataCache::rulesConfigChanged);
+    connect(m_configWatcher, &KDirWatch::deleted, this, &AppDataCache::rulesConfigChanged);
+}
+
+AppDataCache::~AppDataCache() = default;
+
+std::shared_ptr<AppDataCache> AppDataCache::instance()
+{
+    static std::weak_ptr<AppDataCache> s_instance;
+    if (s_instance.expired()) {
+        std::shared_ptr<AppDataCache> ptr(new AppDataCache);
+        s_instance = ptr;
+        return ptr;
+    }
+    return s_instance.lock();
+}
+
+KSharedConfig::Ptr AppDataCache::rulesConfig() const
+{
+    return m_rulesConfig;
+}
+
+QUrl AppDataCache::windowUrl(const QString &appId, quint32 pid, const QString &xWindowsWMClassName)
+{
+    const QString key = appId + u'\n' + xWindowsWMClassName + u'\n' + processKey(pid);
+
+    if (const QUrl *url = m_windowUrls.object(key)) {
+        return *url;
+    }
+
+    const QUrl url = windowUrlFromMetadata(appId, pid, m_rulesConfig, xWindowsWMClassName);
+    m_windowUrls.insert(key, new QUrl(url));
+    return url;
+}
+
+AppData AppDataCache::appData(const QUrl &url)
+{
+    if (const AppDataEntry *entry = m_appData.object(url)) {
+        return entry->data;
+    }
+
+    auto entry = new AppDataEntry;
+    // Remember the desktop file, so a change of an unrelated one doesn't drop the entry.
+    entry->data = appDataFromUrl(url, QIcon(), &entry->desktopPath);
+
+    if (!entry->desktopPath.isEmpty()) {
+        entry->desktopModified = QFileInfo(entry->desktopPath).lastModified();
+    }
+
+    const AppData data = entry->data;
+    m_appData.insert(url, entry);
+    return data;
+}
+
+bool AppDataCache::isUnchanged(const AppDataEntry &entry) const
+{
+    if (entry.desktopPath.isEmpty()) {
+        // Nothing matched, or an executable did: a new desktop file may match now.
+        return false;
+    }
+
+    // A desktop file of the same name elsewhere in the search path may take over, too.
+    const KService::Ptr service = KService::serviceByStorageId(entry.data.id);
+    if (service && service->entryPath() != entry.desktopPath) {
+        return false;
+    }
+
+    const QFileInfo info(entry.desktopPath);
+    return info.exists() && info.lastModified() == entry.desktopModified;
+}
+
+void AppDataCache::sycocaChanged()
+{
+    QSet<QUrl> urls;
+
+    const QList<QUrl> appDataUrls = m_appData.keys();
+    for (const QUrl &url : appDataUrls) {
+        const AppDataEntry *entry = m_appData.object(url);
+        if (!isUnchanged(*entry)) {
+            urls.insert(url);
+            urls.insert(entry->data.url);
+            m_appData.remove(url);
+        }
+    }
+
+    // A window url is only still right if the app data it led to is.
+    const QStringList keys = m_windowUrls.keys();
+    for (const QString &key : keys) {
+        const QUrl url = *m_windowUrls.object(key);
+        if (url.isEmpty() || !m_appData.contains(url)) {
+            urls.insert(url);
+            m_windowUrls.remove(key);
+        }
+    }
+
+    if (!urls.isEmpty()) {
+        Q_EMIT appDataChanged(urls);
+    }
+}
+
+void AppDataCache::rulesConfigChanged()
+{
+    m_rulesConfig->reparseConfiguration();
+    m_windowUrls.clear();
+    m_appData.clear();
+
+    Q_EMIT rulesChanged();
+}
+}
+
+#include "moc_appdatacache.cpp"
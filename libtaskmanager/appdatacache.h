@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <QCache>
+#include <QDateTime>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+
+#include <KSharedConfig>
+
+#include "tasktools.h"
+
+class KDirWatch;
+
+namespace TaskManager
+{
+/**
+ * Process-wide cache of the application data of windows, shared by the window
+ * task models.
+ *
+ * Resolving a window to an application queries the service database, reads the
+ * rules in taskmanagerrulesrc and may inspect the window's process. Windows of
+ * the same application carry the same metadata, so the results are cached by the
+ * metadata and process instead of by window: opening many windows of an
+ * application only resolves it once.
+ *
+ * When the service database changes, only the entries whose desktop file changed
+ * or that didn't resolve to a desktop file are dropped, see appDataChanged().
+ *
+ * @internal
+ */
+class AppDataCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~AppDataCache() override;
+
+    static std::shared_ptr<AppDataCache> instance();
+
+    KSharedConfig::Ptr rulesConfig() const;
+
+    /**
+     * windowUrlFromMetadata() with the rules from taskmanagerrulesrc, cached by
+     * @p appId, @p xWindowsWMClassName and the process @p pid, which is told
+     * apart from a later one with the same pid by its start time.
+     */
+    QUrl windowUrl(const QString &appId, quint32 pid, const QString &xWindowsWMClassName);
+
+    /**
+     * appDataFromUrl() without a fallback icon, cached by @p url.
+     */
+    AppData appData(const QUrl &url);
+
+Q_SIGNALS:
+    /**
+     * Desktop files changed. The cached app data with one of @p urls as its url is
+     * gone, windows using it have to look it up again.
+     */
+    void appDataChanged(const QSet<QUrl> &urls);
+
+    /**
+     * The rules changed, every window has to look up its app data again.
+     */
+    void rulesChanged();
+
+private:
+    AppDataCache();
+
+    void sycocaChanged();
+    void rulesConfigChanged();
+
+    struct AppDataEntry {
+        AppData data;
+        /// The desktop file the data was read from, empty if there is none
+        QString desktopPath;
+        QDateTime desktopModified;
+    };
+
+    bool isUnchanged(const AppDataEntry &entry) const;
+
+    KSharedConfig::Ptr m_rulesConfig;
+    KDirWatch *m_configWatcher = nullptr;
+    QTimer m_sycocaChangeTimer;
+    QCache<QString, QUrl> m_windowUrls;
+    QCache<QUrl, AppDataEntry> m_appData;
+};
+}
@@ -0,0 +1,205 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "appdatasnapshot.h"
+#include "libtaskmanager_debug.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIcon>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+namespace TaskManager
+{
+namespace
+{
+constexpr quint32 s_magic = 0x544d4153; // "TMAS"
+constexpr quint32 s_version = 1;
+}
+
+QDataStream &operator<<(QDataStream &stream, const AppDataSnapshot::Entry &entry)
+{
+    return stream << entry.id << entry.name << entry.genericName << entry.iconName << entry.url << entry.skipTaskbar << entry.desktopPath
+                  << entry.desktopModified;
+}
+
+QDataStream &operator>>(QDataStream &stream, AppDataSnapshot::Entry &entry)
+{
+    return stream >> entry.id >> entry.name >> entry.genericName >> entry.iconName >> entry.url >> entry.skipTaskbar >> entry.desktopPath
+        >> entry.desktopModified;
+}
+
+AppDataSnapshot::AppDataSnapshot()
+{
+    // Launchers are resolved in bursts, e.g. when a panel is set up.
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(5s);
+    QObject::connect(&m_saveTimer, &QTimer::timeout, &m_saveTimer, [this] {
+        save();
+    });
+
+    load();
+}
+
+AppDataSnapshot::~AppDataSnapshot()
+{
+    save();
+}
+
+std::shared_ptr<AppDataSnapshot> AppDataSnapshot::instance()
+{
+    static std::weak_ptr<AppDataSnapshot> s_instance;
+    if (s_instance.expired()) {
+        std::shared_ptr<AppDataSnapshot> ptr(new AppDataSnapshot);
+        s_instance = ptr;
+        return ptr;
+    }
+    return s_instance.lock();
+}
+
+QString AppDataSnapshot::fileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + u"/libtaskmanager/launcherappdata"_s;
+}
+
+void AppDataSnapshot::load()
+{
+    QFile file(fileName());
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+
+    if (magic != s_magic || version != s_version) {
+        qCDebug(TASKMANAGER_DEBUG) << "Ignoring launcher snapshot of an unknown format" << file.fileName();
+        return;
+    }
+
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    QHash<QUrl, Entry> entries;
+    stream >> entries;
+
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(TASKMANAGER_DEBUG) << "Ignoring corrupt launcher snapshot" << file.fileName();
+        return;
+    }
+
+    m_entries = std::move(entries);
+}
+
+void AppDataSnapshot::save()
+{
+    m_saveTimer.stop();
+
+    if (!m_dirty) {
+        return;
+    }
+
+    m_dirty = false;
+
+    QHash<QUrl, Entry> entries;
+    for (const QUrl &url : std::as_const(m_used)) {
+        if (const auto it = m_entries.constFind(url); it != m_entries.constEnd()) {
+            entries.insert(url, *it);
+        }
+    }
+
+    QDir().mkpath(QFileInfo(fileName()).path());
+
+    QSaveFile file(fileName());
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(TASKMANAGER_DEBUG) << "Failed to write launcher snapshot" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_magic << s_version;
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << entries;
+
+    if (!file.commit()) {
+        qCWarning(TASKMANAGER_DEBUG) << "Failed to write launcher snapshot" << file.fileName() << file.errorString();
+    }
+}
+
+std::optional<AppData> AppDataSnapshot::appData(const QUrl &url)
+{
+    const auto it = m_entries.constFind(url);
+
+    if (it == m_entries.constEnd()) {
+        return std::nullopt;
+    }
+
+    if (!it->desktopPath.isEmpty() && QFileInfo(it->desktopPath).lastModified() != it->desktopModified) {
+        return std::nullopt;
+    }
+
+    m_used.insert(url);
+
+    AppData data;
+    data.id = it->id;
+    data.name = it->name;
+    data.genericName = it->genericName;
+    data.icon = QIcon::fromTheme(it->iconName);
+    data.url = it->url;
+    data.skipTaskbar = it->skipTaskbar;
+    return data;
+}
+
+void AppDataSnapshot::insert(const QUrl &url, const AppData &data, const QString &desktopPath)
+{
+    m_used.insert(url);
+
+    if (data.icon.name().isEmpty()) {
+        if (m_entries.remove(url)) {
+            m_dirty = true;
+            m_saveTimer.start();
+        }
+        return;
+    }
+
+    Entry entry{
+        .id = data.id,
+        .name = data.name,
+        .genericName = data.genericName,
+        .iconName = data.icon.name(),
+        .url = data.url,
+        .skipTaskbar = data.skipTaskbar,
+        .desktopPath = desktopPath,
+    };
+
+    if (!entry.desktopPath.isEmpty()) {
+        entry.desktopModified = QFileInfo(entry.desktopPath).lastModified();
+    }
+
+    const auto it = m_entries.constFind(url);
+
+    if (it != m_entries.constEnd() && it->id == entry.id && it->name == entry.name && it->genericName == entry.genericName && it->iconName == entry.iconName
+        && it->url == entry.url && it->skipTaskbar == entry.skipTaskbar && it->desktopPath == entry.desktopPath
+        && it->desktopModified == entry.desktopModified) {
+        return;
+    }
+
+    m_entries.insert(url, entry);
+    m_dirty = true;
+    m_saveTimer.start();
+}
+}
@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+
+#include "taskmanager_export.h"
+#include "tasktools.h"
+
+namespace TaskManager
+{
+/**
+ * The app data launchers resolved to in the previous session, kept on disk.
+ *
+ * Resolving a launcher queries the service database and reads its desktop file.
+ * With many launchers, doing that for all of them at startup delays the first
+ * paint of the task manager. The snapshot lets it show them right away; the
+ * launcher model resolves them for real once it's up and corrects what changed.
+ *
+ * An entry is only handed out while its desktop file is unchanged. Launchers
+ * without a themed icon are not kept, their icon can't be restored by name.
+ *
+ * @internal
+ */
+class TASKMANAGER_EXPORT AppDataSnapshot
+{
+public:
+    ~AppDataSnapshot();
+
+    static std::shared_ptr<AppDataSnapshot> instance();
+
+    /**
+     * The app data @p url resolved to last time, unless it's outdated.
+     */
+    std::optional<AppData> appData(const QUrl &url);
+
+    /**
+     * Remembers that @p url resolved to @p data, read from the desktop file
+     * @p desktopPath. Written to disk shortly after.
+     */
+    void insert(const QUrl &url, const AppData &data, const QString &desktopPath);
+
+    /**
+     * Writes the entries used in this session to disk, if any changed.
+     */
+    void save();
+
+    static QString fileName();
+
+private:
+    AppDataSnapshot();
+
+    void load();
+
+    struct Entry {
+        QString id;
+        QString name;
+        QString genericName;
+        QString iconName;
+        QUrl url;
+        bool skipTaskbar = false;
+        /// The desktop file the data was read from, empty if there is none
+        QString desktopPath;
+        QDateTime desktopModified;
+    };
+
+    friend QDataStream &operator<<(QDataStream &stream, const Entry &entry);
+    friend QDataStream &operator>>(QDataStream &stream, Entry &entry);
+
+    QHash<QUrl, Entry> m_entries;
+    // Entries of launchers that still exist, the others aren't saved again.
+    QSet<QUrl> m_used;
+    bool m_dirty = false;
+    QTimer m_saveTimer;
+};
+}
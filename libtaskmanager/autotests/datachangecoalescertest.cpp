@@ -0,0 +1,148 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QObject>
+#include <QTest>
+
+#include "abstracttasksmodel.h"
+#include "datachangecoalescer.h"
+
+using namespace TaskManager;
+
+class DataChangeCoalescerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+
+    void testMergesFrequentChanges();
+    void testOtherChangesTakePendingAlong();
+    void testRemove();
+    void testAdaptiveInterval();
+    void testBurstOver();
+
+private:
+    struct Emitted {
+        int window;
+        QList<int> roles;
+    };
+
+    void waitForFlush();
+
+    std::unique_ptr<DataChangeCoalescer<int>> m_coalescer;
+    QList<Emitted> m_emitted;
+};
+
+void DataChangeCoalescerTest::init()
+{
+    m_emitted.clear();
+    m_coalescer = std::make_unique<DataChangeCoalescer<int>>([this](int window, const QList<int> &roles) {
+        m_emitted.append({window, roles});
+    });
+}
+
+void DataChangeCoalescerTest::waitForFlush()
+{
+    const qsizetype before = m_emitted.size();
+    QTRY_VERIFY_WITH_TIMEOUT(m_emitted.size() > before, 1000);
+}
+
+void DataChangeCoalescerTest::testMergesFrequentChanges()
+{
+    // A terminal showing build progress in its title
+    for (int i = 0; i < 100; ++i) {
+        m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    }
+    m_coalescer->dataChanged(1, {Qt::DecorationRole});
+    m_coalescer->dataChanged(2, {AbstractTasksModel::Geometry, AbstractTasksModel::ScreenGeometry});
+
+    QVERIFY(m_emitted.isEmpty());
+    waitForFlush();
+    QCOMPARE(m_emitted.size(), 2);
+
+    for (const Emitted &emitted : std::as_const(m_emitted)) {
+        if (emitted.window == 1) {
+            QCOMPARE(emitted.roles, (QList<int>{Qt::DisplayRole, Qt::DecorationRole}));
+        } else {
+            QCOMPARE(emitted.window, 2);
+            QCOMPARE(emitted.roles, (QList<int>{AbstractTasksModel::Geometry, AbstractTasksModel::ScreenGeometry}));
+        }
+    }
+
+    QCOMPARE(m_coalescer->stats().changes, quint64(102));
+    QCOMPARE(m_coalescer->stats().emitted, quint64(2));
+    QCOMPARE(m_coalescer->stats().saved(), quint64(100));
+}
+
+void DataChangeCoalescerTest::testOtherChangesTakePendingAlong()
+{
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    m_coalescer->dataChanged(2, {Qt::DisplayRole});
+
+    // State changes are announced right away, with what's pending for the same window
+    m_coalescer->dataChanged(1, {AbstractTasksModel::IsActive});
+    QCOMPARE(m_emitted.size(), 1);
+    QCOMPARE(m_emitted.constFirst().window, 1);
+    QCOMPARE(m_emitted.constFirst().roles, (QList<int>{Qt::DisplayRole, AbstractTasksModel::IsActive}));
+
+    waitForFlush();
+    QCOMPARE(m_emitted.size(), 2);
+    QCOMPARE(m_emitted.constLast().window, 2);
+}
+
+void DataChangeCoalescerTest::testRemove()
+{
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    m_coalescer->dataChanged(2, {Qt::DisplayRole});
+    m_coalescer->remove(1);
+
+    waitForFlush();
+    QCOMPARE(m_emitted.size(), 1);
+    QCOMPARE(m_emitted.constFirst().window, 2);
+}
+
+void DataChangeCoalescerTest::testAdaptiveInterval()
+{
+    const int frame = m_coalescer->interval();
+
+    // Changes keep coming and are mostly merged away, so the interval grows
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    waitForFlush();
+    QCOMPARE(m_coalescer->interval(), 2 * frame);
+
+    // A single change per window and flush lets it shrink again
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    waitForFlush();
+    QCOMPARE(m_coalescer->interval(), frame);
+}
+
+void DataChangeCoalescerTest::testBurstOver()
+{
+    // Up to twice the interval, changes still belong to the same burst
+    QVERIFY(!DataChangeCoalescerBase::isBurstOver(0, 16));
+    QVERIFY(!DataChangeCoalescerBase::isBurstOver(32, 16));
+    QVERIFY(DataChangeCoalescerBase::isBurstOver(33, 16));
+
+    const int frame = m_coalescer->interval();
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    waitForFlush();
+    QCOMPARE(m_coalescer->interval(), 2 * frame);
+
+    // A longer pause drops the grown interval right away, not only after the next flush
+    QTest::qWait(2 * m_coalescer->interval() + 50);
+    m_coalescer->dataChanged(1, {Qt::DisplayRole});
+    QCOMPARE(m_coalescer->interval(), frame);
+    waitForFlush();
+}
+
+QTEST_GUILESS_MAIN(DataChangeCoalescerTest)
+
+#include "datachangecoalescertest.moc"
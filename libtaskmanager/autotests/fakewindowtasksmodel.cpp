@@ -0,0 +1,316 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "fakewindowtasksmodel.h"
+
+#include <QDebug>
+#include <QIODevice>
+#include <QUrl>
+
+using namespace Qt::StringLiterals;
+using namespace TaskManager;
+
+FakeWindowTasksModel::FakeWindowTasksModel(QObject *parent)
+    : AbstractWindowTasksModel(parent)
+{
+    connect(&m_replayTimer, &QTimer::timeout, this, [this] {
+        apply(m_replayEvents.at(m_replayPosition++));
+
+        if (m_replayPosition == m_replayEvents.size()) {
+            m_replayTimer.stop();
+            m_replayEvents.clear();
+            Q_EMIT replayFinished();
+        }
+    });
+}
+
+FakeWindowTasksModel::~FakeWindowTasksModel() = default;
+
+int FakeWindowTasksModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_windows.size());
+}
+
+QVariant FakeWindowTasksModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) {
+        return QVariant();
+    }
+
+    const Window &window = m_windows.at(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return window.title;
+    case AppId:
+        return window.appId;
+    case AppName:
+        return window.appName;
+    case LauncherUrl:
+    case LauncherUrlWithoutIcon:
+        return QUrl(u"applications:%1.desktop"_s.arg(window.appId));
+    case WinIdList:
+        return QVariantList{window.id};
+    case IsWindow:
+        return true;
+    case IsActive:
+        return window.id == m_activeWindow;
+    case IsClosable:
+    case IsMovable:
+    case IsResizable:
+    case IsMaximizable:
+    case IsMinimizable:
+    case IsVirtualDesktopsChangeable:
+        return true;
+    case IsMinimized:
+    case IsHidden:
+        return window.minimized;
+    case VirtualDesktops:
+        return window.virtualDesktops;
+    case IsOnAllVirtualDesktops:
+        return window.virtualDesktops.isEmpty();
+    case Geometry:
+        return window.geometry;
+    case ScreenGeometry:
+        return QRect(0, 0, 1920, 1080);
+    case Activities:
+        return window.activities;
+    case StackingOrder:
+        return index.row();
+    case LastActivated:
+        return window.lastActivated;
+    }
+
+    return AbstractTasksModel::data(index, role);
+}
+
+void FakeWindowTasksModel::requestActivate(const QModelIndex &index)
+{
+    if (checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) {
+        setActive(m_windows.at(index.row()).id);
+    }
+}
+
+int FakeWindowTasksModel::row(quint32 id) const
+{
+    return m_rows.value(id, -1);
+}
+
+void FakeWindowTasksModel::changed(int row, const QList<int> &roles)
+{
+    if (row != -1) {
+        const QModelIndex idx = index(row);
+        Q_EMIT dataChanged(idx, idx, roles);
+    }
+}
+
+void FakeWindowTasksModel::addWindow(const Window &window)
+{
+    if (m_rows.contains(window.id)) {
+        return;
+    }
+
+    const int row = int(m_windows.size());
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.insert(window.id, row);
+    m_windows.append(window);
+    endInsertRows();
+}
+
+void FakeWindowTasksModel::removeWindow(quint32 id)
+{
+    const int row = this->row(id);
+
+    if (row == -1) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_windows.removeAt(row);
+    m_rows.remove(id);
+    for (int i = row; i < m_windows.size(); ++i) {
+        m_rows[m_windows.at(i).id] = i;
+    }
+    if (m_activeWindow == id) {
+        m_activeWindow = 0;
+    }
+    endRemoveRows();
+}
+
+void FakeWindowTasksModel::setTitle(quint32 id, const QString &title)
+{
+    const int row = this->row(id);
+
+    if (row != -1 && m_windows.at(row).title != title) {
+        m_windows[row].title = title;
+        changed(row, {Qt::DisplayRole});
+    }
+}
+
+void FakeWindowTasksModel::setActive(quint32 id)
+{
+    if (m_activeWindow == id) {
+        return;
+    }
+
+    const int oldRow = row(m_activeWindow);
+    const int newRow = row(id);
+    m_activeWindow = id;
+
+    changed(oldRow, {IsActive});
+
+    if (newRow != -1) {
+        m_windows[newRow].lastActivated = QDateTime::currentDateTime();
+        changed(newRow, {IsActive, LastActivated});
+    }
+}
+
+void FakeWindowTasksModel::setMinimized(quint32 id, bool minimized)
+{
+    const int row = this->row(id);
+
+    if (row != -1 && m_windows.at(row).minimized != minimized) {
+        m_windows[row].minimized = minimized;
+        changed(row, {IsMinimized, IsHidden});
+    }
+}
+
+void FakeWindowTasksModel::setVirtualDesktops(quint32 id, const QVariantList &desktops)
+{
+    const int row = this->row(id);
+
+    if (row != -1 && m_windows.at(row).virtualDesktops != desktops) {
+        m_windows[row].virtualDesktops = desktops;
+        changed(row, {VirtualDesktops, IsOnAllVirtualDesktops});
+    }
+}
+
+void FakeWindowTasksModel::clear()
+{
+    beginResetModel();
+    m_windows.clear();
+    m_rows.clear();
+    m_activeWindow = 0;
+    endResetModel();
+}
+
+void FakeWindowTasksModel::apply(const Event &event)
+{
+    switch (event.type) {
+    case Event::Add: {
+        Window window;
+        window.id = event.window;
+        window.appId = event.argument;
+        window.appName = event.argument;
+        window.title = u"%1 %2"_s.arg(event.argument).arg(event.window);
+        window.geometry = QRect(int(event.window % 32) * 40, int(event.window % 16) * 40, 800, 600);
+        addWindow(window);
+        break;
+    }
+    case Event::Remove:
+        removeWindow(event.window);
+        break;
+    case Event::Title:
+        setTitle(event.window, event.argument);
+        break;
+    case Event::Activate:
+        setActive(event.window);
+        break;
+    case Event::Minimize: {
+        const int row = this->row(event.window);
+        if (row != -1) {
+            setMinimized(event.window, !m_windows.at(row).minimized);
+        }
+        break;
+    }
+    case Event::Move:
+        setVirtualDesktops(event.window, event.argument.isEmpty() ? QVariantList() : QVariantList{event.argument});
+        break;
+    }
+}
+
+void FakeWindowTasksModel::replay(const QList<Event> &events)
+{
+    for (const Event &event : events) {
+        apply(event);
+    }
+}
+
+void FakeWindowTasksModel::replay(const QList<Event> &events, int eventsPerSecond)
+{
+    m_replayTimer.stop();
+    m_replayEvents = events;
+    m_replayPosition = 0;
+
+    if (m_replayEvents.isEmpty()) {
+        Q_EMIT replayFinished();
+        return;
+    }
+
+    m_replayTimer.setTimerType(Qt::PreciseTimer);
+    m_replayTimer.start(std::max(1, 1000 / std::max(1, eventsPerSecond)));
+}
+
+QList<FakeWindowTasksModel::Event> FakeWindowTasksModel::parseTrace(QIODevice *device)
+{
+    static const QHash<QString, Event::Type> types{
+        {u"add"_s, Event::Add},
+        {u"remove"_s, Event::Remove},
+        {u"title"_s, Event::Title},
+        {u"activate"_s, Event::Activate},
+        {u"minimize"_s, Event::Minimize},
+        {u"move"_s, Event::Move},
+    };
+
+    QList<Event> events;
+
+    while (!device->atEnd()) {
+        const QString line = QString::fromUtf8(device->readLine()).trimmed();
+
+        if (line.isEmpty() || line.startsWith(u'#')) {
+            continue;
+        }
+
+        const QStringList fields = line.split(u' ');
+        const auto type = types.constFind(fields.at(0));
+
+        if (type == types.constEnd() || fields.size() < 2) {
+            qWarning() << "Skipping malformed trace line" << line;
+            continue;
+        }
+
+        events.append({*type, fields.at(1).toUInt(), fields.mid(2).join(u' ')});
+    }
+
+    return events;
+}
+
+QList<FakeWindowTasksModel::Event> FakeWindowTasksModel::generateTrace(int windowCount, int appCount, int changesPerWindow)
+{
+    QList<Event> events;
+    events.reserve(windowCount * (2 + 3 * changesPerWindow));
+
+    // Window ids start at 1, 0 means no window.
+    for (quint32 id = 1; id <= quint32(windowCount); ++id) {
+        events.append({Event::Add, id, u"org.kde.app%1"_s.arg(id % appCount)});
+    }
+
+    for (int round = 0; round < changesPerWindow; ++round) {
+        for (quint32 id = 1; id <= quint32(windowCount); ++id) {
+            events.append({Event::Title, id, u"Window %1 (%2%)"_s.arg(id).arg(round)});
+            events.append({Event::Activate, id, QString()});
+            events.append({Event::Move, id, u"desktop%1"_s.arg((id + round) % 4)});
+        }
+    }
+
+    for (quint32 id = 1; id <= quint32(windowCount); ++id) {
+        events.append({Event::Remove, id, QString()});
+    }
+
+    return events;
+}
+
+#include "moc_fakewindowtasksmodel.cpp"
@@ -0,0 +1,117 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QRect>
+#include <QTimer>
+
+#include "abstractwindowtasksmodel.h"
+
+class QIODevice;
+
+/**
+ * A window tasks model without a windowing system behind it, for tests and
+ * benchmarks of the models on top.
+ *
+ * Windows are added, changed and removed by calling the methods below, or by
+ * replaying a trace of such events, either all at once or at a given rate.
+ */
+class FakeWindowTasksModel : public TaskManager::AbstractWindowTasksModel
+{
+    Q_OBJECT
+
+public:
+    struct Window {
+        quint32 id = 0;
+        QString appId;
+        QString appName;
+        QString title;
+        QVariantList virtualDesktops;
+        QStringList activities;
+        QRect geometry;
+        bool minimized = false;
+        QDateTime lastActivated;
+    };
+
+    struct Event {
+        enum Type {
+            Add, ///< Adds window @c window of application @c argument
+            Remove,
+            Title, ///< Sets the title to @c argument
+            Activate,
+            Minimize, ///< Toggles the minimized state
+            Move, ///< Moves the window to the desktop @c argument
+        };
+
+        Type type = Add;
+        quint32 window = 0;
+        QString argument;
+    };
+
+    explicit FakeWindowTasksModel(QObject *parent = nullptr);
+    ~FakeWindowTasksModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    void requestActivate(const QModelIndex &index) override;
+
+    void addWindow(const Window &window);
+    void removeWindow(quint32 id);
+    void setTitle(quint32 id, const QString &title);
+    void setActive(quint32 id);
+    void setMinimized(quint32 id, bool minimized);
+    void setVirtualDesktops(quint32 id, const QVariantList &desktops);
+    void clear();
+
+    /**
+     * Applies @p event, as the windowing system would announce it.
+     */
+    void apply(const Event &event);
+
+    /**
+     * Applies all of @p events right away.
+     */
+    void replay(const QList<Event> &events);
+
+    /**
+     * Applies @p events at @p eventsPerSecond from the event loop, then emits
+     * replayFinished(). Replaces a replay still running.
+     */
+    void replay(const QList<Event> &events, int eventsPerSecond);
+
+    /**
+     * Reads a recorded trace. Every line is an event: the type (add, remove, title,
+     * activate, minimize or move), the window id and for some types an argument,
+     * separated by spaces. Empty lines and lines starting with # are skipped.
+     */
+    static QList<Event> parseTrace(QIODevice *device);
+
+    /**
+     * A trace of @p windowCount windows of @p appCount applications being opened,
+     * then @p changesPerWindow rounds of title changes, activations and desktop
+     * changes, and finally every window being closed.
+     */
+    static QList<Event> generateTrace(int windowCount, int appCount, int changesPerWindow);
+
+Q_SIGNALS:
+    void replayFinished();
+
+private:
+    int row(quint32 id) const;
+    void changed(int row, const QList<int> &roles);
+
+    QList<Window> m_windows;
+    QHash<quint32, int> m_rows;
+    quint32 m_activeWindow = 0;
+
+    QTimer m_replayTimer;
+    QList<Event> m_replayEvents;
+    qsizetype m_replayPosition = 0;
+};
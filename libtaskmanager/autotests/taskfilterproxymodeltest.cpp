@@ -0,0 +1,172 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTest>
+
+#include "abstracttasksmodel.h"
+#include "taskfilterproxymodel.h"
+
+using namespace Qt::StringLiterals;
+using namespace TaskManager;
+
+class TaskFilterProxyModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testVirtualDesktopSwitch();
+    void testActivitySwitch();
+    void testScreenSwitch();
+    void testRowChanges();
+
+private:
+    QStandardItem *addWindow(const QString &title, const QVariantList &desktops, const QStringList &activities = {}, const QRect &screen = {});
+    QStringList titles() const;
+
+    std::unique_ptr<QStandardItemModel> m_sourceModel;
+    std::unique_ptr<TaskFilterProxyModel> m_model;
+};
+
+void TaskFilterProxyModelTest::init()
+{
+    m_sourceModel = std::make_unique<QStandardItemModel>();
+    m_model = std::make_unique<TaskFilterProxyModel>();
+    m_model->setSourceModel(m_sourceModel.get());
+}
+
+void TaskFilterProxyModelTest::cleanup()
+{
+    m_model.reset();
+    m_sourceModel.reset();
+}
+
+QStandardItem *TaskFilterProxyModelTest::addWindow(const QString &title, const QVariantList &desktops, const QStringList &activities, const QRect &screen)
+{
+    auto item = new QStandardItem(title);
+    item->setData(true, AbstractTasksModel::IsWindow);
+    item->setData(desktops, AbstractTasksModel::VirtualDesktops);
+    item->setData(desktops.isEmpty(), AbstractTasksModel::IsOnAllVirtualDesktops);
+    item->setData(activities, AbstractTasksModel::Activities);
+    item->setData(screen, AbstractTasksModel::ScreenGeometry);
+    m_sourceModel->appendRow(item);
+    return item;
+}
+
+QStringList TaskFilterProxyModelTest::titles() const
+{
+    QStringList titles;
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        titles.append(m_model->index(row, 0).data().toString());
+    }
+    return titles;
+}
+
+void TaskFilterProxyModelTest::testVirtualDesktopSwitch()
+{
+    QAbstractItemModelTester tester(m_model.get());
+
+    addWindow(u"a"_s, {u"desktop1"_s});
+    addWindow(u"b"_s, {u"desktop2"_s});
+    addWindow(u"everywhere"_s, {});
+    addWindow(u"ab"_s, {u"desktop1"_s, u"desktop2"_s});
+
+    m_model->setVirtualDesktop(u"desktop1"_s);
+    m_model->setFilterByVirtualDesktop(true);
+    QCOMPARE(titles(), (QStringList{u"a"_s, u"everywhere"_s, u"ab"_s}));
+
+    m_model->setVirtualDesktop(u"desktop2"_s);
+    QCOMPARE(titles(), (QStringList{u"b"_s, u"everywhere"_s, u"ab"_s}));
+
+    m_model->setVirtualDesktop(u"desktop3"_s);
+    QCOMPARE(titles(), (QStringList{u"everywhere"_s}));
+
+    // No window is restricted to either desktop, so nothing is filtered again
+    QSignalSpy inserted(m_model.get(), &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(m_model.get(), &QAbstractItemModel::rowsRemoved);
+    m_model->setVirtualDesktop(u"desktop4"_s);
+    QCOMPARE(titles(), (QStringList{u"everywhere"_s}));
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(removed.count(), 0);
+
+    m_model->setVirtualDesktop(u"desktop1"_s);
+    QCOMPARE(titles(), (QStringList{u"a"_s, u"everywhere"_s, u"ab"_s}));
+}
+
+void TaskFilterProxyModelTest::testActivitySwitch()
+{
+    addWindow(u"work"_s, {}, {u"work"_s});
+    addWindow(u"play"_s, {}, {u"play"_s});
+    addWindow(u"anywhere"_s, {}, {});
+
+    m_model->setActivity(u"work"_s);
+    m_model->setFilterByActivity(true);
+    QCOMPARE(titles(), (QStringList{u"work"_s, u"anywhere"_s}));
+
+    m_model->setActivity(u"play"_s);
+    QCOMPARE(titles(), (QStringList{u"play"_s, u"anywhere"_s}));
+
+    m_model->setActivity(u"other"_s);
+    QCOMPARE(titles(), (QStringList{u"anywhere"_s}));
+}
+
+void TaskFilterProxyModelTest::testScreenSwitch()
+{
+    const QRect left(0, 0, 1920, 1080);
+    const QRect right(1920, 0, 1920, 1080);
+
+    addWindow(u"left"_s, {}, {}, left);
+    addWindow(u"right"_s, {}, {}, right);
+    addWindow(u"unknown"_s, {}, {}, QRect());
+
+    m_model->setScreenGeometry(left);
+    m_model->setFilterByScreen(true);
+    QCOMPARE(titles(), (QStringList{u"left"_s, u"unknown"_s}));
+
+    m_model->setScreenGeometry(right);
+    QCOMPARE(titles(), (QStringList{u"right"_s, u"unknown"_s}));
+}
+
+void TaskFilterProxyModelTest::testRowChanges()
+{
+    QAbstractItemModelTester tester(m_model.get());
+
+    QStandardItem *a = addWindow(u"a"_s, {u"desktop1"_s});
+    addWindow(u"b"_s, {u"desktop2"_s});
+
+    m_model->setVirtualDesktop(u"desktop1"_s);
+    m_model->setFilterByVirtualDesktop(true);
+    QCOMPARE(titles(), (QStringList{u"a"_s}));
+
+    // Moving a window updates what's known about it
+    a->setData(QVariantList{u"desktop3"_s}, AbstractTasksModel::VirtualDesktops);
+    QCOMPARE(titles(), QStringList());
+    m_model->setVirtualDesktop(u"desktop3"_s);
+    QCOMPARE(titles(), (QStringList{u"a"_s}));
+
+    // Rows coming and going keep the rest in place
+    m_sourceModel->insertRow(0, new QStandardItem(u"launcher"_s));
+    QCOMPARE(titles(), (QStringList{u"launcher"_s, u"a"_s}));
+    m_sourceModel->removeRow(2);
+    m_model->setVirtualDesktop(u"desktop2"_s);
+    QCOMPARE(titles(), (QStringList{u"launcher"_s}));
+    m_model->setVirtualDesktop(u"desktop3"_s);
+    QCOMPARE(titles(), (QStringList{u"launcher"_s, u"a"_s}));
+
+    // A window demanding attention is shown everywhere
+    a->setData(true, AbstractTasksModel::IsDemandingAttention);
+    m_model->setVirtualDesktop(u"desktop1"_s);
+    QCOMPARE(titles(), (QStringList{u"launcher"_s, u"a"_s}));
+}
+
+QTEST_GUILESS_MAIN(TaskFilterProxyModelTest)
+
+#include "taskfilterproxymodeltest.moc"
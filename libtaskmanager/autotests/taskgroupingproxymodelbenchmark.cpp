@@ -0,0 +1,185 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTest>
+
+#include "abstracttasksmodel.h"
+#include "taskgroupingproxymodel.h"
+
+using namespace Qt::StringLiterals;
+using namespace TaskManager;
+
+namespace
+{
+constexpr int s_windowCount = 500;
+constexpr int s_appCount = 50;
+}
+
+/**
+ * Stresses the source-to-proxy mapping of TaskGroupingProxyModel with a busy taskbar:
+ * 500 windows of 50 applications, so most of them end up in groups.
+ */
+class TaskGroupingProxyModelBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testMapping();
+    void testDataChangedRanges();
+    void benchmarkMapFromSource();
+    void benchmarkDataChanged();
+    void benchmarkRowChurn();
+    void benchmarkRebuild();
+
+private:
+    static QStandardItem *createWindow(int serial);
+    void verifyMapping();
+
+    std::unique_ptr<QStandardItemModel> m_sourceModel;
+    std::unique_ptr<TaskGroupingProxyModel> m_model;
+    int m_serial = 0;
+};
+
+QStandardItem *TaskGroupingProxyModelBenchmark::createWindow(int serial)
+{
+    auto item = new QStandardItem(u"Window %1"_s.arg(serial));
+    item->setData(true, AbstractTasksModel::IsWindow);
+    item->setData(u"org.kde.app%1"_s.arg(serial % s_appCount), AbstractTasksModel::AppId);
+    item->setData(u"App %1"_s.arg(serial % s_appCount), AbstractTasksModel::AppName);
+    return item;
+}
+
+void TaskGroupingProxyModelBenchmark::init()
+{
+    m_sourceModel = std::make_unique<QStandardItemModel>();
+    for (m_serial = 0; m_serial < s_windowCount; ++m_serial) {
+        m_sourceModel->appendRow(createWindow(m_serial));
+    }
+
+    m_model = std::make_unique<TaskGroupingProxyModel>();
+    m_model->setGroupMode(TasksModel::GroupApplications);
+    m_model->setSourceModel(m_sourceModel.get());
+    QCOMPARE(m_model->rowCount(), s_appCount);
+}
+
+void TaskGroupingProxyModelBenchmark::cleanup()
+{
+    m_model.reset();
+    m_sourceModel.reset();
+}
+
+void TaskGroupingProxyModelBenchmark::verifyMapping()
+{
+    for (int row = 0; row < m_sourceModel->rowCount(); ++row) {
+        const QModelIndex sourceIndex = m_sourceModel->index(row, 0);
+        const QModelIndex proxyIndex = m_model->mapFromSource(sourceIndex);
+        QVERIFY(proxyIndex.isValid());
+        QCOMPARE(m_model->mapToSource(proxyIndex), sourceIndex);
+        QCOMPARE(proxyIndex.data().toString(), sourceIndex.data().toString());
+    }
+}
+
+void TaskGroupingProxyModelBenchmark::testMapping()
+{
+    QAbstractItemModelTester tester(m_model.get());
+    verifyMapping();
+
+    // Remove windows from the front, middle and end, from groups and group members alike
+    m_sourceModel->removeRows(0, 3);
+    m_sourceModel->removeRows(200, 10);
+    m_sourceModel->removeRow(m_sourceModel->rowCount() - 1);
+    verifyMapping();
+
+    // A new application in the middle, and more windows of a grouped one at the front
+    auto newApp = createWindow(++m_serial);
+    newApp->setData(u"org.kde.newapp"_s, AbstractTasksModel::AppId);
+    m_sourceModel->insertRow(100, newApp);
+    m_sourceModel->insertRow(0, createWindow(++m_serial));
+    m_sourceModel->insertRow(0, createWindow(++m_serial));
+    verifyMapping();
+    QCOMPARE(m_model->rowCount(), s_appCount + 1);
+
+    // Breaking all groups up and forming them again
+    m_model->setGroupMode(TasksModel::GroupDisabled);
+    QCOMPARE(m_model->rowCount(), m_sourceModel->rowCount());
+    verifyMapping();
+    m_model->setGroupMode(TasksModel::GroupApplications);
+    QCOMPARE(m_model->rowCount(), s_appCount + 1);
+    verifyMapping();
+
+    // Removing the only window of an application
+    const QModelIndexList newAppIndexes = m_sourceModel->match(m_sourceModel->index(0, 0), AbstractTasksModel::AppId, u"org.kde.newapp"_s);
+    QCOMPARE(newAppIndexes.size(), 1);
+    m_sourceModel->removeRow(newAppIndexes.constFirst().row());
+    QCOMPARE(m_model->rowCount(), s_appCount);
+    verifyMapping();
+}
+
+void TaskGroupingProxyModelBenchmark::testDataChangedRanges()
+{
+    QSignalSpy dataChanged(m_model.get(), &QAbstractItemModel::dataChanged);
+
+    // Every window changes at once: one range of group parents, and one of the members of each group
+    Q_EMIT m_sourceModel->dataChanged(m_sourceModel->index(0, 0), m_sourceModel->index(s_windowCount - 1, 0), {Qt::DisplayRole});
+    QCOMPARE(dataChanged.count(), s_appCount + 1);
+
+    for (const QList<QVariant> &arguments : std::as_const(dataChanged)) {
+        const auto topLeft = arguments.at(0).value<QModelIndex>();
+        const auto bottomRight = arguments.at(1).value<QModelIndex>();
+        QCOMPARE(topLeft.parent(), bottomRight.parent());
+        QCOMPARE(topLeft.row(), 0);
+        QCOMPARE(bottomRight.row(), topLeft.parent().isValid() ? s_windowCount / s_appCount - 1 : s_appCount - 1);
+        QCOMPARE(arguments.at(2).value<QList<int>>(), QList<int>{Qt::DisplayRole});
+    }
+}
+
+void TaskGroupingProxyModelBenchmark::benchmarkMapFromSource()
+{
+    QBENCHMARK {
+        for (int row = 0; row < s_windowCount; ++row) {
+            m_model->mapFromSource(m_sourceModel->index(row, 0));
+        }
+    }
+}
+
+void TaskGroupingProxyModelBenchmark::benchmarkDataChanged()
+{
+    // A title change of every window, like a wall of terminals running builds
+    int generation = 0;
+    QBENCHMARK {
+        ++generation;
+        for (int row = 0; row < s_windowCount; ++row) {
+            m_sourceModel->item(row)->setText(u"Window %1 (%2)"_s.arg(row).arg(generation));
+        }
+    }
+}
+
+void TaskGroupingProxyModelBenchmark::benchmarkRowChurn()
+{
+    // Short-lived windows opening and closing at the front of the source model
+    QBENCHMARK {
+        m_sourceModel->insertRow(0, createWindow(++m_serial));
+        m_sourceModel->removeRow(0);
+    }
+}
+
+void TaskGroupingProxyModelBenchmark::benchmarkRebuild()
+{
+    QBENCHMARK {
+        m_model->setSourceModel(nullptr);
+        m_model->setSourceModel(m_sourceModel.get());
+    }
+}
+
+QTEST_MAIN(TaskGroupingProxyModelBenchmark)
+
+#include "taskgroupingproxymodelbenchmark.moc"
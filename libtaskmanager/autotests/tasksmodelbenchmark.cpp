@@ -0,0 +1,217 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+#include "fakewindowtasksmodel.h"
+#include "tasksmodel.h"
+#include "windowtasksmodel_p.h"
+
+using namespace Qt::StringLiterals;
+using namespace TaskManager;
+
+namespace
+{
+constexpr int s_appCount = 20;
+}
+
+/**
+ * Measures how long window changes take to make it through the whole TasksModel
+ * chain (concatenating, filtering, grouping and sorting), with the windows coming
+ * from FakeWindowTasksModel instead of a windowing system.
+ */
+class TasksModelBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void testReplayRecordedTrace();
+    void testReplayRate();
+
+    void benchmarkAddWindows_data();
+    void benchmarkAddWindows();
+    void benchmarkTitleChange_data();
+    void benchmarkTitleChange();
+    void benchmarkActivate_data();
+    void benchmarkActivate();
+    void benchmarkReplayTrace_data();
+    void benchmarkReplayTrace();
+
+private:
+    static void addWindowCount();
+    void addWindows(int count);
+
+    FakeWindowTasksModel *m_windows = nullptr;
+    TasksModel *m_model = nullptr;
+};
+
+void TasksModelBenchmark::initTestCase()
+{
+    m_windows = new FakeWindowTasksModel(this);
+    setWindowTasksSourceModelForTesting(m_windows);
+
+    m_model = new TasksModel(this);
+    m_model->setGroupMode(TasksModel::GroupApplications);
+    m_model->setSortMode(TasksModel::SortAlpha);
+
+    // TasksModel sets up its source model from the event loop
+    QTRY_VERIFY(m_model->sourceModel());
+}
+
+void TasksModelBenchmark::cleanupTestCase()
+{
+    delete m_model;
+    m_model = nullptr;
+    setWindowTasksSourceModelForTesting(nullptr);
+}
+
+void TasksModelBenchmark::init()
+{
+    m_windows->clear();
+    QCOMPARE(m_model->rowCount(), 0);
+}
+
+void TasksModelBenchmark::addWindowCount()
+{
+    QTest::addColumn<int>("windowCount");
+
+    QTest::newRow("10 windows") << 10;
+    QTest::newRow("100 windows") << 100;
+    QTest::newRow("1000 windows") << 1000;
+}
+
+void TasksModelBenchmark::addWindows(int count)
+{
+    for (quint32 id = 1; id <= quint32(count); ++id) {
+        m_windows->apply({FakeWindowTasksModel::Event::Add, id, u"org.kde.app%1"_s.arg(id % s_appCount)});
+    }
+}
+
+void TasksModelBenchmark::testReplayRecordedTrace()
+{
+    QFile trace(QFINDTESTDATA("data/traces/busy-session.trace"));
+    QVERIFY(trace.open(QIODevice::ReadOnly));
+
+    const QList<FakeWindowTasksModel::Event> events = FakeWindowTasksModel::parseTrace(&trace);
+    QVERIFY(!events.isEmpty());
+
+    m_windows->replay(events);
+
+    // One terminal, the first browser window and the file manager are left
+    QCOMPARE(m_windows->rowCount(), 3);
+    QCOMPARE(m_model->rowCount(), 3);
+
+    QStringList appIds;
+    QModelIndex konsole;
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        const QModelIndex index = m_model->index(row, 0);
+        QVERIFY(!m_model->data(index, AbstractTasksModel::IsGroupParent).toBool());
+        appIds.append(m_model->data(index, AbstractTasksModel::AppId).toString());
+        if (appIds.constLast() == u"org.kde.konsole"_s) {
+            konsole = index;
+        }
+    }
+    appIds.sort();
+    QCOMPARE(appIds, (QStringList{u"firefox"_s, u"org.kde.dolphin"_s, u"org.kde.konsole"_s}));
+
+    QVERIFY(konsole.isValid());
+    QCOMPARE(m_model->data(konsole, Qt::DisplayRole).toString(), u"make: [100%] Built target plasma-workspace"_s);
+    QVERIFY(m_model->data(konsole, AbstractTasksModel::IsActive).toBool());
+}
+
+void TasksModelBenchmark::testReplayRate()
+{
+    const QList<FakeWindowTasksModel::Event> events = FakeWindowTasksModel::generateTrace(10, 3, 1);
+    QSignalSpy finished(m_windows, &FakeWindowTasksModel::replayFinished);
+
+    m_windows->replay(events, 200);
+    QCOMPARE(m_model->rowCount(), 0);
+
+    // Windows of the same application end up in one group while the trace plays
+    QTRY_COMPARE(m_model->rowCount(), 3);
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(m_model->rowCount(), 0);
+}
+
+void TasksModelBenchmark::benchmarkAddWindows_data()
+{
+    addWindowCount();
+}
+
+void TasksModelBenchmark::benchmarkAddWindows()
+{
+    QFETCH(int, windowCount);
+
+    QBENCHMARK {
+        m_windows->clear();
+        addWindows(windowCount);
+    }
+
+    QCOMPARE(m_model->rowCount(), std::min(windowCount, s_appCount));
+}
+
+void TasksModelBenchmark::benchmarkTitleChange_data()
+{
+    addWindowCount();
+}
+
+void TasksModelBenchmark::benchmarkTitleChange()
+{
+    QFETCH(int, windowCount);
+    addWindows(windowCount);
+
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (quint32 id = 1; id <= quint32(windowCount); ++id) {
+            m_windows->setTitle(id, u"Window %1 (%2)"_s.arg(id).arg(round));
+        }
+    }
+}
+
+void TasksModelBenchmark::benchmarkActivate_data()
+{
+    addWindowCount();
+}
+
+void TasksModelBenchmark::benchmarkActivate()
+{
+    QFETCH(int, windowCount);
+    addWindows(windowCount);
+
+    QBENCHMARK {
+        for (quint32 id = 1; id <= quint32(windowCount); ++id) {
+            m_windows->setActive(id);
+        }
+    }
+}
+
+void TasksModelBenchmark::benchmarkReplayTrace_data()
+{
+    addWindowCount();
+}
+
+void TasksModelBenchmark::benchmarkReplayTrace()
+{
+    QFETCH(int, windowCount);
+    const QList<FakeWindowTasksModel::Event> events = FakeWindowTasksModel::generateTrace(windowCount, s_appCount, 3);
+
+    QBENCHMARK {
+        m_windows->replay(events);
+    }
+
+    QCOMPARE(m_model->rowCount(), 0);
+}
+
+QTEST_MAIN(TasksModelBenchmark)
+
+#include "tasksmodelbenchmark.moc"
@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "datachangecoalescer.h"
+#include "abstracttasksmodel.h"
+#include "libtaskmanager_debug.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+
+namespace TaskManager
+{
+namespace
+{
+// How far the interval may grow while changes keep coming, in frames.
+constexpr int s_maxFrames = 8;
+
+DataChangeCoalescerBase::Stats s_totalStats;
+}
+
+DataChangeCoalescerBase::DataChangeCoalescerBase()
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [this] {
+        timeout();
+    });
+}
+
+DataChangeCoalescerBase::~DataChangeCoalescerBase()
+{
+    qCDebug(TASKMANAGER_DEBUG) << "Coalesced" << m_stats.changes << "data changes into" << m_stats.emitted << "signals";
+}
+
+DataChangeCoalescerBase::Stats DataChangeCoalescerBase::stats() const
+{
+    return m_stats;
+}
+
+DataChangeCoalescerBase::Stats DataChangeCoalescerBase::totalStats()
+{
+    return s_totalStats;
+}
+
+int DataChangeCoalescerBase::interval() const
+{
+    return m_frames * frameInterval();
+}
+
+bool DataChangeCoalescerBase::isCoalescable(int role)
+{
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::DecorationRole:
+    case AbstractTasksModel::Geometry:
+    case AbstractTasksModel::ScreenGeometry:
+    case AbstractTasksModel::StackingOrder:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool DataChangeCoalescerBase::isBurstOver(qint64 pause, int interval)
+{
+    return pause > 2 * qint64(interval);
+}
+
+void DataChangeCoalescerBase::schedule()
+{
+    ++m_queuedSinceFlush;
+
+    if (m_timer.isActive()) {
+        return;
+    }
+
+    if (m_sinceFlush.isValid() && isBurstOver(m_sinceFlush.elapsed(), interval())) {
+        m_frames = 1;
+    }
+
+    m_timer.start(interval());
+}
+
+void DataChangeCoalescerBase::countChange()
+{
+    ++m_stats.changes;
+    ++s_totalStats.changes;
+}
+
+void DataChangeCoalescerBase::countEmitted()
+{
+    ++m_stats.emitted;
+    ++s_totalStats.emitted;
+}
+
+void DataChangeCoalescerBase::timeout()
+{
+    const int queued = std::exchange(m_queuedSinceFlush, 0);
+    const quint64 emittedBefore = m_stats.emitted;
+
+    flush();
+
+    // If most changes were merged away, waiting longer saves more of them;
+    // otherwise, go back towards announcing them every frame.
+    const quint64 flushed = m_stats.emitted - emittedBefore;
+
+    if (quint64(queued) > 2 * flushed) {
+        m_frames = std::min(m_frames * 2, s_maxFrames);
+    } else {
+        m_frames = std::max(m_frames / 2, 1);
+    }
+
+    m_sinceFlush.start();
+}
+
+int DataChangeCoalescerBase::frameInterval()
+{
+    qreal refreshRate = 60;
+
+    if (const QScreen *screen = QGuiApplication::primaryScreen(); screen && screen->refreshRate() > 0) {
+        refreshRate = screen->refreshRate();
+    }
+
+    return std::max(1, qRound(1000 / refreshRate));
+}
+}
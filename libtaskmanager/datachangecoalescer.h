@@ -0,0 +1,177 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "taskmanager_export.h"
+
+namespace TaskManager
+{
+/**
+ * The part of DataChangeCoalescer that doesn't depend on the window type.
+ *
+ * @internal
+ */
+class TASKMANAGER_EXPORT DataChangeCoalescerBase
+{
+public:
+    struct Stats {
+        /// Changes announced by the windowing system
+        quint64 changes = 0;
+        /// dataChanged() signals these resulted in
+        quint64 emitted = 0;
+
+        quint64 saved() const
+        {
+            return changes - emitted;
+        }
+    };
+
+    virtual ~DataChangeCoalescerBase();
+
+    Stats stats() const;
+
+    /**
+     * The stats of all coalescers in the process, including destroyed ones.
+     */
+    static Stats totalStats();
+
+    /**
+     * The time pending changes currently wait for at most.
+     */
+    int interval() const;
+
+    /**
+     * Whether @p role changes frequently enough to be worth coalescing. A change
+     * of any other role is announced right away.
+     */
+    static bool isCoalescable(int role);
+
+    /**
+     * Whether a pause of @p pause ms since the last flush ends a burst of changes,
+     * dropping the interval back to one frame. That is a pause of more than twice
+     * the @p interval the changes were announced with, the timer alone may take
+     * a little longer than one interval.
+     */
+    static bool isBurstOver(qint64 pause, int interval);
+
+protected:
+    DataChangeCoalescerBase();
+
+    void schedule();
+    void countChange();
+    void countEmitted();
+
+    virtual void flush() = 0;
+
+private:
+    void timeout();
+    static int frameInterval();
+
+    QTimer m_timer;
+    QElapsedTimer m_sinceFlush;
+    int m_frames = 1;
+    int m_queuedSinceFlush = 0;
+    Stats m_stats;
+};
+
+/**
+ * Coalesces the dataChanged() signals of a window tasks model.
+ *
+ * Applications that update their window title many times a second, e.g. to show
+ * progress, or windows being dragged, would otherwise keep every proxy model and
+ * delegate on top of the model busy. Changes of frequently changing roles are
+ * merged per window and announced once per frame. When changes keep coming, the
+ * interval grows up to a few frames, and it drops back to one frame once things
+ * calm down.
+ *
+ * A change of any other role is announced right away, along with the pending
+ * changes of the same window.
+ *
+ * @internal
+ */
+template<typename WindowId>
+class DataChangeCoalescer : public DataChangeCoalescerBase
+{
+public:
+    /**
+     * @param emitter emits dataChanged() for a window, if it's still in the model.
+     */
+    explicit DataChangeCoalescer(std::function<void(WindowId, const QList<int> &)> emitter)
+        : m_emitter(std::move(emitter))
+    {
+    }
+
+    ~DataChangeCoalescer() override = default;
+
+    void dataChanged(WindowId window, const QList<int> &roles)
+    {
+        countChange();
+
+        if (std::all_of(roles.cbegin(), roles.cend(), &DataChangeCoalescerBase::isCoalescable)) {
+            QList<int> &pending = m_pending[window];
+
+            for (int role : roles) {
+                if (!pending.contains(role)) {
+                    pending.append(role);
+                }
+            }
+
+            schedule();
+
+            return;
+        }
+
+        QList<int> merged = m_pending.take(window);
+
+        for (int role : roles) {
+            if (!merged.contains(role)) {
+                merged.append(role);
+            }
+        }
+
+        countEmitted();
+        m_emitter(window, merged);
+    }
+
+    /**
+     * Drops the pending changes of @p window, call this when it goes away.
+     */
+    void remove(WindowId window)
+    {
+        m_pending.remove(window);
+    }
+
+    void clear()
+    {
+        m_pending.clear();
+    }
+
+protected:
+    void flush() override
+    {
+        const QHash<WindowId, QList<int>> pending = std::exchange(m_pending, {});
+
+        for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+            countEmitted();
+            m_emitter(it.key(), it.value());
+        }
+    }
+
+private:
+    std::function<void(WindowId, const QList<int> &)> m_emitter;
+    QHash<WindowId, QList<int>> m_pending;
+};
+}
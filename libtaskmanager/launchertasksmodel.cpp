@@ -5,6 +5,7 @@
 */
 
 #include "launchertasksmodel.h"
+#include "appdatasnapshot.h"
 #include "tasktools.h"
 
 #include <KDesktopFile>
@@ -25,7 +26,9 @@
 #include <QUrlQuery>
 
 #include "launchertasksmodel_p.h"
+#include "tasktools_p.h"
 #include <chrono>
+#include <utility>
 
 using namespace std::chrono_literals;
 
@@ -61,8 +64,16 @@ public:
     QHash<QUrl, AppData> appDataCache;
     QTimer sycocaChangeTimer;
 
+    // Launchers shown with the app data of the previous session, resolved for
+    // real once the model is up.
+    std::shared_ptr<AppDataSnapshot> snapshot = AppDataSnapshot::instance();
+    bool useSnapshot = true;
+    QList<QUrl> unresolvedLaunchers;
+    QTimer resolveTimer;
+
     void init();
     AppData appData(const QUrl &url);
+    void resolveLaunchers();
 
     bool requestAddLauncherToActivities(const QUrl &_url, const QStringList &activities);
     bool requestRemoveLauncherFromActivities(const QUrl &_url, const QStringList &activities);
@@ -82,6 +93,9 @@ void LauncherTasksModel::Private::init()
     sycocaChangeTimer.setInterval(100ms);
 
     QObject::connect(&sycocaChangeTimer, &QTimer::timeout, q, [this]() {
+        // The snapshot is only for getting started.
+        useSnapshot = false;
+
         if (!launchersOrder.count()) {
             return;
         }
@@ -103,6 +117,13 @@ void LauncherTasksModel::Private::init()
     QObject::connect(KSycoca::self(), &KSycoca::databaseChanged, q, [this]() {
         sycocaChangeTimer.start();
     });
+
+    // Late enough for the launchers to have been painted once.
+    resolveTimer.setSingleShot(true);
+    resolveTimer.setInterval(1s);
+    QObject::connect(&resolveTimer, &QTimer::timeout, q, [this]() {
+        resolveLaunchers();
+    });
 }
 
 AppData LauncherTasksModel::Private::appData(const QUrl &url)
@@ -113,13 +134,56 @@ AppData LauncherTasksModel::Private::appData(const QUrl &url)
         return *it;
     }
 
-    const AppData &data = appDataFromUrl(url, QIcon::fromTheme(QLatin1String("unknown")));
+    if (const std::optional<AppData> data = useSnapshot ? snapshot->appData(url) : std::nullopt) {
+        appDataCache.insert(url, *data);
+        unresolvedLaunchers.append(url);
+        resolveTimer.start();
+
+        return *data;
+    }
+
+    QString desktopPath;
+    const AppData data = appDataFromUrl(url, QIcon::fromTheme(QLatin1String("unknown")), &desktopPath);
 
     appDataCache.insert(url, data);
+    snapshot->insert(url, data, desktopPath);
 
     return data;
 }
 
+void LauncherTasksModel::Private::resolveLaunchers()
+{
+    for (const QUrl &url : std::exchange(unresolvedLaunchers, {})) {
+        const int row = launchersOrder.indexOf(url);
+
+        // Gone, or already resolved again after a service database change
+        if (row == -1 || !appDataCache.contains(url)) {
+            continue;
+        }
+
+        QString desktopPath;
+        const AppData data = appDataFromUrl(url, QIcon::fromTheme(QLatin1String("unknown")), &desktopPath);
+        const AppData previous = appDataCache.value(url);
+
+        appDataCache.insert(url, data);
+        snapshot->insert(url, data, desktopPath);
+
+        if (data.id != previous.id || data.name != previous.name || data.genericName != previous.genericName || data.url != previous.url
+            || data.icon.name() != previous.icon.name() || data.skipTaskbar != previous.skipTaskbar) {
+            Q_EMIT q->dataChanged(q->index(row, 0),
+                                  q->index(row, 0),
+                                  QList<int>{Qt::DisplayRole,
+                                             Qt::DecorationRole,
+                                             AbstractTasksModel::AppId,
+                                             AbstractTasksModel::AppName,
+                                             AbstractTasksModel::GenericName,
+                                             AbstractTasksModel::LauncherUrl,
+                                             AbstractTasksModel::LauncherUrlWithoutIcon,
+                                             AbstractTasksModel::SkipTaskbar});
+        }
+    }
+}
+
 bool LauncherTasksModel::Private::requestAddLauncherToActivities(const QUrl &_url, const QStringList &_activities)
 {
     QUrl url(_url);
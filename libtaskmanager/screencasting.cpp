@@ -5,12 +5,30 @@
 */
 
 #include "screencasting.h"
+#include "libtaskmanager_debug.h"
 #include <QDebug>
 #include <QGuiApplication>
 #include <QPointer>
 #include <QScreen>
 #include <qpa/qplatformnativeinterface.h>
 
+#include <chrono>
+#include <optional>
+
+using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+namespace
+{
+// Long enough to move the mouse to the next task and back, short enough not to
+// keep a window busy rendering for nothing.
+constexpr auto s_streamLinger = 2s;
+// A group tooltip shows a thumbnail of each window in it.
+constexpr qsizetype s_maxStreams = 8;
+// In KiB, the images are full-size frames.
+constexpr qsizetype s_maxStillFrameCost = 32 * 1024;
+}
+
 ScreencastingStream::ScreencastingStream()
 {
 }
@@ -20,24 +38,42 @@ ScreencastingStream::~ScreencastingStream()
     close();
 }
 
+quint32 ScreencastingStream::nodeId() const
+{
+    return m_nodeId;
+}
+
+bool ScreencastingStream::isClosed() const
+{
+    return m_closed;
+}
+
 void ScreencastingStream::zkde_screencast_stream_unstable_v1_created(uint32_t node)
 {
+    m_nodeId = node;
     Q_EMIT created(node);
 }
 
 void ScreencastingStream::zkde_screencast_stream_unstable_v1_closed()
 {
+    m_nodeId = 0;
+    m_closed = true;
     Q_EMIT closed();
 }
 
 void ScreencastingStream::zkde_screencast_stream_unstable_v1_failed(const QString &error)
 {
+    m_closed = true;
     Q_EMIT failed(error);
 }
 
 Screencasting::Screencasting()
     : QWaylandClientExtensionTemplate<Screencasting>(ZKDE_SCREENCAST_UNSTABLE_V1_STREAM_REGION_SINCE_VERSION)
+    , m_stillFrames(s_maxStillFrameCost)
 {
+    m_lingerTimer.setSingleShot(true);
+    connect(&m_lingerTimer, &QTimer::timeout, this, &Screencasting::closeExpiredStreams);
+
     initialize();
 
     if (!isInitialized()) {
@@ -47,11 +83,24 @@ Screencasting::Screencasting()
 
 Screencasting::~Screencasting()
 {
+    m_lingeringStreams.clear();
+
     if (isActive()) {
         destroy();
     }
 }
 
+std::shared_ptr<Screencasting> Screencasting::instance()
+{
+    static std::weak_ptr<Screencasting> s_instance;
+    if (s_instance.expired()) {
+        std::shared_ptr<Screencasting> ptr(new Screencasting);
+        s_instance = ptr;
+        return ptr;
+    }
+    return s_instance.lock();
+}
+
 std::unique_ptr<ScreencastingStream> Screencasting::createOutputStream(const QString &outputName, pointer mode)
 {
     if (!isActive()) {
@@ -85,4 +134,146 @@ std::unique_ptr<ScreencastingStream> Screencasting::createWindowStream(const QSt
     return stream;
 }
 
+std::shared_ptr<ScreencastingStream> Screencasting::acquireWindowStream(const QString &uuid, pointer mode)
+{
+    return acquire(u"window:%1:%2"_s.arg(uuid).arg(int(mode)), [this, uuid, mode] {
+        return createWindowStream(uuid, mode);
+    });
+}
+
+std::shared_ptr<ScreencastingStream> Screencasting::acquireOutputStream(const QString &outputName, pointer mode)
+{
+    return acquire(u"output:%1:%2"_s.arg(outputName).arg(int(mode)), [this, outputName, mode] {
+        return createOutputStream(outputName, mode);
+    });
+}
+
+std::shared_ptr<ScreencastingStream> Screencasting::acquire(const QString &key, const std::function<std::unique_ptr<ScreencastingStream>()> &create)
+{
+    if (std::shared_ptr<ScreencastingStream> stream = m_streams.value(key).lock(); stream && !stream->isClosed()) {
+        return stream;
+    }
+
+    std::unique_ptr<ScreencastingStream> stream;
+
+    if (auto it = m_lingeringStreams.find(key); it != m_lingeringStreams.end()) {
+        stream = std::move(it->stream);
+        m_lingeringStreams.erase(it);
+
+        if (stream->isClosed()) {
+            stream.reset();
+        }
+    }
+
+    if (!stream) {
+        while (m_streams.size() + m_lingeringStreams.size() >= s_maxStreams) {
+            if (!evictLingeringStream()) {
+                qCDebug(TASKMANAGER_DEBUG) << "Not starting a stream for" << key << "with" << m_streams.size() << "streams in use";
+                return nullptr;
+            }
+        }
+
+        stream = create();
+
+        if (!stream) {
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<ScreencastingStream> shared(stream.release(), [self = QPointer<Screencasting>(this), key](ScreencastingStream *stream) {
+        if (self) {
+            self->release(key, stream);
+        } else {
+            delete stream;
+        }
+    });
+    m_streams.insert(key, shared);
+    return shared;
+}
+
+void Screencasting::release(const QString &key, ScreencastingStream *stream)
+{
+    // A stream the compositor closed may have been replaced by a new one in the meantime.
+    if (auto it = m_streams.find(key); it != m_streams.end() && it->expired()) {
+        m_streams.erase(it);
+    }
+
+    if (stream->isClosed() || m_lingeringStreams.contains(key)) {
+        delete stream;
+    } else {
+        m_lingeringStreams.insert(key, {std::unique_ptr<ScreencastingStream>(stream), QDeadlineTimer(s_streamLinger)});
+
+        if (!m_lingerTimer.isActive()) {
+            m_lingerTimer.start(s_streamLinger);
+        }
+    }
+
+    // A lingering stream can be evicted for a new one
+    Q_EMIT streamSlotFreed();
+}
+
+void Screencasting::closeExpiredStreams()
+{
+    std::optional<QDeadlineTimer> next;
+
+    for (auto it = m_lingeringStreams.begin(); it != m_lingeringStreams.end();) {
+        if (it->deadline.hasExpired()) {
+            it = m_lingeringStreams.erase(it);
+            continue;
+        }
+
+        if (!next || it->deadline < *next) {
+            next = it->deadline;
+        }
+        ++it;
+    }
+
+    if (next) {
+        m_lingerTimer.start(std::chrono::ceil<std::chrono::milliseconds>(next->remainingTimeAsDuration()));
+    }
+}
+
+bool Screencasting::evictLingeringStream()
+{
+    auto oldest = m_lingeringStreams.end();
+
+    for (auto it = m_lingeringStreams.begin(); it != m_lingeringStreams.end(); ++it) {
+        if (oldest == m_lingeringStreams.end() || it->deadline < oldest->deadline) {
+            oldest = it;
+        }
+    }
+
+    if (oldest == m_lingeringStreams.end()) {
+        return false;
+    }
+
+    m_lingeringStreams.erase(oldest);
+    return true;
+}
+
+QImage Screencasting::stillFrame(const QString &source) const
+{
+    if (const QImage *frame = m_stillFrames.object(source)) {
+        return *frame;
+    }
+    return QImage();
+}
+
+void Screencasting::setStillFrame(const QString &source, const QImage &frame)
+{
+    if (source.isEmpty()) {
+        return;
+    }
+
+    if (frame.isNull()) {
+        if (!m_stillFrames.remove(source)) {
+            return;
+        }
+    } else {
+        m_stillFrames.insert(source, new QImage(frame), std::max<qsizetype>(1, frame.sizeInBytes() / 1024));
+    }
+
+    Q_EMIT stillFrameChanged(source);
+}
+
 #include "moc_screencasting.cpp"
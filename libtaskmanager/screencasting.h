@@ -8,10 +8,16 @@
 
 #include "qwayland-zkde-screencast-unstable-v1.h"
 
+#include <QCache>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QImage>
 #include <QObject>
+#include <QTimer>
 #include <QWaylandClientExtensionTemplate>
 #include <qqmlregistration.h>
 
+#include <functional>
 #include <memory>
 
 class ScreencastingStream : public QObject, public QtWayland::zkde_screencast_stream_unstable_v1
@@ -22,6 +28,16 @@ public:
     ScreencastingStream();
     ~ScreencastingStream() override;
 
+    /**
+     * The PipeWire node of the stream, 0 until the compositor created it.
+     */
+    quint32 nodeId() const;
+
+    /**
+     * Whether the compositor closed the stream or failed to create it.
+     */
+    bool isClosed() const;
+
 Q_SIGNALS:
     void created(quint32 nodeid);
     void failed(const QString &error);
@@ -31,6 +47,10 @@ protected:
     void zkde_screencast_stream_unstable_v1_created(uint32_t node) override;
     void zkde_screencast_stream_unstable_v1_closed() override;
     void zkde_screencast_stream_unstable_v1_failed(const QString &error) override;
+
+private:
+    quint32 m_nodeId = 0;
+    bool m_closed = false;
 };
 
 class Screencasting : public QWaylandClientExtensionTemplate<Screencasting>, public QtWayland::zkde_screencast_unstable_v1
@@ -43,6 +63,54 @@ public:
     explicit Screencasting();
     ~Screencasting() override;
 
+    static std::shared_ptr<Screencasting> instance();
+
     std::unique_ptr<ScreencastingStream> createOutputStream(const QString &outputName, pointer mode);
     std::unique_ptr<ScreencastingStream> createWindowStream(const QString &uuid, pointer mode);
+
+    /**
+     * A stream of the window @p uuid, shared with everyone else casting it.
+     *
+     * Once the last user lets go of a stream, it lingers for a moment, so hovering
+     * back and forth over tasks picks the running stream up again instead of
+     * negotiating a new one. At most a few streams run at a time: when that many
+     * are in use, nullptr is returned and the still frame is all there is until
+     * streamSlotFreed() is emitted.
+     */
+    std::shared_ptr<ScreencastingStream> acquireWindowStream(const QString &uuid, pointer mode);
+
+    /**
+     * Same as acquireWindowStream(), for the output @p outputName.
+     */
+    std::shared_ptr<ScreencastingStream> acquireOutputStream(const QString &outputName, pointer mode);
+
+    /**
+     * The last frame a user of the stream of the window or output @p source
+     * remembered, to show while no stream is running.
+     */
+    QImage stillFrame(const QString &source) const;
+    void setStillFrame(const QString &source, const QImage &frame);
+
+Q_SIGNALS:
+    void stillFrameChanged(const QString &source);
+    /**
+     * A stream is no longer in use, acquiring one may succeed again.
+     */
+    void streamSlotFreed();
+
+private:
+    struct LingeringStream {
+        std::unique_ptr<ScreencastingStream> stream;
+        QDeadlineTimer deadline;
+    };
+
+    std::shared_ptr<ScreencastingStream> acquire(const QString &key, const std::function<std::unique_ptr<ScreencastingStream>()> &create);
+    void release(const QString &key, ScreencastingStream *stream);
+    void closeExpiredStreams();
+    bool evictLingeringStream();
+
+    QHash<QString, std::weak_ptr<ScreencastingStream>> m_streams;
+    QHash<QString, LingeringStream> m_lingeringStreams;
+    QTimer m_lingerTimer;
+    QCache<QString, QImage> m_stillFrames;
 };
@@ -35,13 +35,9 @@ void ScreencastingRequest::setUuid(const QString &uuid)
     setStream(nullptr);
     m_uuid = uuid;
     Q_EMIT uuidChanged(uuid);
+    Q_EMIT stillFrameChanged();
 
-    if (!m_uuid.isEmpty()) {
-        if (!m_screenCasting) {
-            m_screenCasting = std::make_unique<Screencasting>();
-        }
-        setStream(m_screenCasting->createWindowStream(m_uuid, Screencasting::pointer_hidden));
-    }
+    acquireStream();
 }
 
 void ScreencastingRequest::resetOutputName()
@@ -58,17 +54,68 @@ void ScreencastingRequest::setOutputName(const QString &outputName)
     setStream(nullptr);
     m_outputName = outputName;
     Q_EMIT outputNameChanged(outputName);
+    Q_EMIT stillFrameChanged();
+
+    acquireStream();
+}
+
+Screencasting *ScreencastingRequest::screencasting()
+{
+    if (!m_screenCasting) {
+        m_screenCasting = Screencasting::instance();
+        connect(m_screenCasting.get(), &Screencasting::stillFrameChanged, this, [this](const QString &source) {
+            if (source == this->source()) {
+                Q_EMIT stillFrameChanged();
+            }
+        });
+        // Queued, so the request letting go of its stream is done with it first
+        connect(
+            m_screenCasting.get(),
+            &Screencasting::streamSlotFreed,
+            this,
+            [this] {
+                if (!m_stream) {
+                    acquireStream();
+                }
+            },
+            Qt::QueuedConnection);
+    }
+    return m_screenCasting.get();
+}
+
+void ScreencastingRequest::acquireStream()
+{
+    if (!m_uuid.isEmpty()) {
+        setStream(screencasting()->acquireWindowStream(m_uuid, Screencasting::pointer_hidden));
+    } else if (!m_outputName.isEmpty()) {
+        setStream(screencasting()->acquireOutputStream(m_outputName, Screencasting::pointer_hidden));
+    }
+}
+
+QString ScreencastingRequest::source() const
+{
+    return m_uuid.isEmpty() ? m_outputName : m_uuid;
+}
+
+QImage ScreencastingRequest::stillFrame() const
+{
+    return m_screenCasting ? m_screenCasting->stillFrame(source()) : QImage();
+}
 
-    if (!m_outputName.isEmpty()) {
-        if (!m_screenCasting) {
-            m_screenCasting = std::make_unique<Screencasting>();
-        }
-        setStream(m_screenCasting->createOutputStream(m_outputName, Screencasting::pointer_hidden));
+void ScreencastingRequest::setStillFrame(const QImage &frame)
+{
+    if (!source().isEmpty()) {
+        screencasting()->setStillFrame(source(), frame);
     }
 }
 
-void ScreencastingRequest::setStream(std::unique_ptr<ScreencastingStream> stream)
+void ScreencastingRequest::setStream(std::shared_ptr<ScreencastingStream> stream)
 {
+    // The stream may live on for other requests
+    if (m_stream) {
+        disconnect(m_stream.get(), nullptr, this, nullptr);
+    }
+
     if (stream) {
         m_stream = std::move(stream);
 
@@ -79,6 +126,9 @@ void ScreencastingRequest::setStream(std::unique_ptr<ScreencastingStream> stream
         connect(m_stream.get(), &ScreencastingStream::failed, this, [](const QString &error) {
             qWarning() << "error creating screencast" << error;
         });
+
+        // A stream picked up again is running already
+        setNodeid(m_stream->nodeId());
     } else {
         m_stream.reset();
         setNodeid(0);
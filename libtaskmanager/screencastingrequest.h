@@ -7,6 +7,7 @@
 #pragma once
 
 #include "screencasting.h"
+#include <QImage>
 #include <QObject>
 #include <qqmlregistration.h>
 
@@ -16,6 +17,12 @@
  *
  * We will get a PipeWire node id that can be fed to any pipewire player, be it
  * the PipeWireSourceItem, GStreamer's pipewiresink or any other.
+ *
+ * Requests for the same window or output share one stream, which stays around
+ * for a moment after the last request let go of it. When too many streams are
+ * running already, nodeId stays 0 until one of them is let go of; the
+ * stillFrame can be shown instead, e.g. by storing a grabToImage() of the
+ * player there when it goes away.
  */
 class ScreencastingRequest : public QObject
 {
@@ -38,6 +45,12 @@ class ScreencastingRequest : public QObject
 
     /** The offered nodeId to give to a source */
     Q_PROPERTY(quint32 nodeId READ nodeId NOTIFY nodeIdChanged)
+
+    /**
+     * The last frame remembered for the window or output, shared with all
+     * requests for it. Null if there is none.
+     */
+    Q_PROPERTY(QImage stillFrame READ stillFrame WRITE setStillFrame NOTIFY stillFrameChanged)
 public:
     ScreencastingRequest(QObject *parent = nullptr);
     ~ScreencastingRequest();
@@ -52,17 +65,24 @@ public:
 
     quint32 nodeId() const;
 
+    QImage stillFrame() const;
+    void setStillFrame(const QImage &frame);
+
 Q_SIGNALS:
     void nodeIdChanged(quint32 nodeId);
     void uuidChanged(const QString &uuid);
     void outputNameChanged(const QString &outputNames);
+    void stillFrameChanged();
 
 private:
+    QString source() const;
+    Screencasting *screencasting();
     void setNodeid(uint nodeId);
-    void setStream(std::unique_ptr<ScreencastingStream> stream);
+    void setStream(std::shared_ptr<ScreencastingStream> stream);
+    void acquireStream();
 
-    std::unique_ptr<Screencasting> m_screenCasting;
-    std::unique_ptr<ScreencastingStream> m_stream;
+    std::shared_ptr<Screencasting> m_screenCasting;
+    std::shared_ptr<ScreencastingStream> m_stream;
     QString m_uuid;
     QString m_outputName;
     quint32 m_nodeId = 0;
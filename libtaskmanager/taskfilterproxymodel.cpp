@@ -9,6 +9,11 @@
 
 #include "launchertasksmodel_p.h"
 
+#include <QHash>
+
+#include <algorithm>
+#include <optional>
+
 #include "config-X11.h"
 #if HAVE_X11
 #include <QGuiApplication>
@@ -43,10 +48,204 @@ public:
     bool filterSkipPager = false;
 
     bool demandingAttentionSkipsFilters = true;
+
+    // The source rows of the data change being processed, if it leaves their filter
+    // result as it was, see isFilterRole(). Only set while QSortFilterProxyModel
+    // handles that change, anything else filtering rows resets it first.
+    std::optional<std::pair<int, int>> unaffectedRows;
+    QList<QMetaObject::Connection> sourceConnections;
+
+    // What acceptsRow() looks at, read from the source once per row and kept until
+    // the row changes, so changing the filter doesn't query every row again.
+    struct RowData {
+        bool skipTaskbar = false;
+        bool skipPager = false;
+        bool onAllVirtualDesktops = false;
+        bool demandingAttention = false;
+        bool minimized = false;
+        bool maximized = false;
+        bool hidden = false;
+        QVariantList virtualDesktops;
+        QRect screenGeometry;
+        QRect geometry;
+        bool hasActivities = false;
+        QStringList activities;
+    };
+
+    mutable QList<std::optional<RowData>> rows;
+    mutable qsizetype knownRows = 0;
+    // How many of the known rows are restricted to each virtual desktop, activity
+    // and screen. Switching between two without any rows can't change the result.
+    mutable QHash<QString, int> desktopRows;
+    mutable QHash<QString, int> activityRows;
+    mutable QHash<QString, int> screenRows;
+
+    bool isFilterRole(int role) const;
+    static bool isRowDataRole(int role);
+
+    const RowData &rowData(const QModelIndex &sourceIndex) const;
+    void countRow(const RowData &data, int delta) const;
+    void forgetRows(int first, int last) const;
+    void clearRows() const;
+    bool hasRowsOn(const QHash<QString, int> &buckets, const QString &from, const QString &to) const;
+    void invalidateFilter();
+
+private:
+    TaskFilterProxyModel *const q;
 };
 
-TaskFilterProxyModel::Private::Private(TaskFilterProxyModel *)
+TaskFilterProxyModel::Private::Private(TaskFilterProxyModel *q)
+    : q(q)
+{
+}
+
+void TaskFilterProxyModel::Private::invalidateFilter()
+{
+    unaffectedRows.reset();
+    q->invalidateFilter();
+}
+
+bool TaskFilterProxyModel::Private::isRowDataRole(int role)
+{
+    switch (role) {
+    case AbstractTasksModel::SkipTaskbar:
+    case AbstractTasksModel::SkipPager:
+    case AbstractTasksModel::IsOnAllVirtualDesktops:
+    case AbstractTasksModel::VirtualDesktops:
+    case AbstractTasksModel::IsDemandingAttention:
+    case AbstractTasksModel::ScreenGeometry:
+    case AbstractTasksModel::Geometry:
+    case AbstractTasksModel::Activities:
+    case AbstractTasksModel::IsMinimized:
+    case AbstractTasksModel::IsMaximized:
+    case AbstractTasksModel::IsHidden:
+        return true;
+    }
+
+    return false;
+}
+
+static QString screenKey(const QRect &geometry)
+{
+    return QStringLiteral("%1,%2 %3x%4").arg(geometry.x()).arg(geometry.y()).arg(geometry.width()).arg(geometry.height());
+}
+
+const TaskFilterProxyModel::Private::RowData &TaskFilterProxyModel::Private::rowData(const QModelIndex &sourceIndex) const
 {
+    const int row = sourceIndex.row();
+
+    if (rows.size() != q->sourceModel()->rowCount()) {
+        clearRows();
+        rows.resize(q->sourceModel()->rowCount());
+    }
+
+    std::optional<RowData> &data = rows[row];
+
+    if (!data) {
+        data = RowData{
+            .skipTaskbar = sourceIndex.data(AbstractTasksModel::SkipTaskbar).toBool(),
+            .skipPager = sourceIndex.data(AbstractTasksModel::SkipPager).toBool(),
+            .onAllVirtualDesktops = sourceIndex.data(AbstractTasksModel::IsOnAllVirtualDesktops).toBool(),
+            .demandingAttention = sourceIndex.data(AbstractTasksModel::IsDemandingAttention).toBool(),
+            .minimized = sourceIndex.data(AbstractTasksModel::IsMinimized).toBool(),
+            .maximized = sourceIndex.data(AbstractTasksModel::IsMaximized).toBool(),
+            .hidden = sourceIndex.data(AbstractTasksModel::IsHidden).toBool(),
+            .virtualDesktops = sourceIndex.data(AbstractTasksModel::VirtualDesktops).toList(),
+            .screenGeometry = sourceIndex.data(AbstractTasksModel::ScreenGeometry).toRect(),
+            .geometry = sourceIndex.data(AbstractTasksModel::Geometry).toRect(),
+        };
+
+        if (const QVariant activities = sourceIndex.data(AbstractTasksModel::Activities); !activities.isNull()) {
+            data->hasActivities = true;
+            data->activities = activities.toStringList();
+        }
+
+        countRow(*data, 1);
+        ++knownRows;
+    }
+
+    return *data;
+}
+
+void TaskFilterProxyModel::Private::countRow(const RowData &data, int delta) const
+{
+    if (!data.onAllVirtualDesktops) {
+        for (const QVariant &desktop : data.virtualDesktops) {
+            desktopRows[desktop.toString()] += delta;
+        }
+    }
+
+    if (data.hasActivities && !data.activities.contains(NULL_UUID)) {
+        for (const QString &activity : data.activities) {
+            activityRows[activity] += delta;
+        }
+    }
+
+    if (data.screenGeometry.isValid()) {
+        screenRows[screenKey(data.screenGeometry)] += delta;
+    }
+}
+
+void TaskFilterProxyModel::Private::forgetRows(int first, int last) const
+{
+    last = std::min(last, int(rows.size()) - 1);
+
+    for (int i = first; i <= last; ++i) {
+        if (std::optional<RowData> &data = rows[i]) {
+            countRow(*data, -1);
+            --knownRows;
+            data.reset();
+        }
+    }
+}
+
+void TaskFilterProxyModel::Private::clearRows() const
+{
+    rows.clear();
+    knownRows = 0;
+    desktopRows.clear();
+    activityRows.clear();
+    screenRows.clear();
+}
+
+bool TaskFilterProxyModel::Private::hasRowsOn(const QHash<QString, int> &buckets, const QString &from, const QString &to) const
+{
+    // Rows not read yet could be anywhere.
+    if (!q->sourceModel() || knownRows != q->sourceModel()->rowCount()) {
+        return true;
+    }
+
+    return buckets.value(from) > 0 || buckets.value(to) > 0;
+}
+
+bool TaskFilterProxyModel::Private::isFilterRole(int role) const
+{
+    // Mirrors the data acceptsRow() looks at with the current filter settings.
+    switch (role) {
+    case AbstractTasksModel::SkipTaskbar:
+        return filterSkipTaskbar;
+    case AbstractTasksModel::SkipPager:
+        return filterSkipPager;
+    case AbstractTasksModel::IsOnAllVirtualDesktops:
+    case AbstractTasksModel::VirtualDesktops:
+        return filterByVirtualDesktop && !virtualDesktop.isNull();
+    case AbstractTasksModel::IsDemandingAttention:
+        return demandingAttentionSkipsFilters && ((filterByVirtualDesktop && !virtualDesktop.isNull()) || (filterByActivity && !activity.isEmpty()));
+    case AbstractTasksModel::ScreenGeometry:
+        return filterByScreen && screenGeometry.isValid();
+    case AbstractTasksModel::Geometry:
+        return filterByRegion != RegionFilterMode::Mode::Disabled && regionGeometry.isValid();
+    case AbstractTasksModel::Activities:
+        return filterByActivity && !activity.isEmpty();
+    case AbstractTasksModel::IsMinimized:
+        return filterMinimized || filterNotMinimized;
+    case AbstractTasksModel::IsMaximized:
+        return filterNotMaximized;
+    case AbstractTasksModel::IsHidden:
+        return filterHidden;
+    }
+
+    return false;
 }
 
 TaskFilterProxyModel::TaskFilterProxyModel(QObject *parent)
@@ -63,7 +262,65 @@ void TaskFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
 {
     d->sourceTasksModel = dynamic_cast<AbstractTasksModelIface *>(sourceModel);
 
+    for (const QMetaObject::Connection &connection : std::as_const(d->sourceConnections)) {
+        disconnect(connection);
+    }
+    d->sourceConnections.clear();
+    d->unaffectedRows.reset();
+    d->clearRows();
+
+    // Connected ahead of QSortFilterProxyModel, so the rows it filters in response
+    // to the same signals are read again where needed.
+    if (sourceModel) {
+        d->sourceConnections << connect(sourceModel,
+                                        &QAbstractItemModel::dataChanged,
+                                        this,
+                                        [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+                                            if (roles.isEmpty() || std::any_of(roles.cbegin(), roles.cend(), &Private::isRowDataRole)) {
+                                                d->forgetRows(topLeft.row(), bottomRight.row());
+                                            }
+
+                                            // QSortFilterProxyModel runs the filter again on every changed row,
+                                            // whatever changed.
+                                            d->unaffectedRows.reset();
+                                            if (!roles.isEmpty() && std::none_of(roles.cbegin(), roles.cend(), [this](int role) {
+                                                    return d->isFilterRole(role);
+                                                })) {
+                                                d->unaffectedRows.emplace(topLeft.row(), bottomRight.row());
+                                            }
+                                        });
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parent, int first, int last) {
+            d->unaffectedRows.reset();
+            if (!parent.isValid() && first <= d->rows.size()) {
+                d->rows.insert(first, (last - first) + 1, std::nullopt);
+            }
+        });
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &parent, int first, int last) {
+            d->unaffectedRows.reset();
+            if (!parent.isValid() && first < d->rows.size()) {
+                d->forgetRows(first, last);
+                d->rows.remove(first, std::min(int(d->rows.size()) - 1, last) - first + 1);
+            }
+        });
+
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsMoved, this, [this]() {
+            d->clearRows();
+        });
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::layoutChanged, this, [this]() {
+            d->clearRows();
+        });
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::modelReset, this, [this]() {
+            d->clearRows();
+        });
+    }
+
     QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    if (sourceModel) {
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this]() {
+            d->unaffectedRows.reset();
+        });
+    }
 }
 
 QVariant TaskFilterProxyModel::virtualDesktop() const
@@ -74,10 +331,11 @@ QVariant TaskFilterProxyModel::virtualDesktop() const
 void TaskFilterProxyModel::setVirtualDesktop(const QVariant &desktop)
 {
     if (d->virtualDesktop != desktop) {
-        d->virtualDesktop = desktop;
+        const QVariant previous = std::exchange(d->virtualDesktop, desktop);
 
-        if (d->filterByVirtualDesktop) {
-            invalidateFilter();
+        if (d->filterByVirtualDesktop
+            && (previous.isNull() || desktop.isNull() || d->hasRowsOn(d->desktopRows, previous.toString(), desktop.toString()))) {
+            d->invalidateFilter();
         }
 
         Q_EMIT virtualDesktopChanged();
@@ -92,10 +350,11 @@ QRect TaskFilterProxyModel::screenGeometry() const
 void TaskFilterProxyModel::setScreenGeometry(const QRect &geometry)
 {
     if (d->screenGeometry != geometry) {
-        d->screenGeometry = geometry;
+        const QRect previous = std::exchange(d->screenGeometry, geometry);
 
-        if (d->filterByScreen) {
-            invalidateFilter();
+        if (d->filterByScreen
+            && (!previous.isValid() || !geometry.isValid() || d->hasRowsOn(d->screenRows, screenKey(previous), screenKey(geometry)))) {
+            d->invalidateFilter();
         }
 
         Q_EMIT screenGeometryChanged();
@@ -115,7 +374,7 @@ void TaskFilterProxyModel::setRegionGeometry(const QRect &geometry)
     d->regionGeometry = geometry;
 
     if (d->filterByRegion != RegionFilterMode::Mode::Disabled) {
-        invalidateFilter();
+        d->invalidateFilter();
     }
 
     Q_EMIT regionGeometryChanged();
@@ -129,10 +388,10 @@ QString TaskFilterProxyModel::activity() const
 void TaskFilterProxyModel::setActivity(const QString &activity)
 {
     if (d->activity != activity) {
-        d->activity = activity;
+        const QString previous = std::exchange(d->activity, activity);
 
-        if (d->filterByActivity) {
-            invalidateFilter();
+        if (d->filterByActivity && (previous.isEmpty() || activity.isEmpty() || d->hasRowsOn(d->activityRows, previous, activity))) {
+            d->invalidateFilter();
         }
 
         Q_EMIT activityChanged();
@@ -149,7 +408,7 @@ void TaskFilterProxyModel::setFilterByVirtualDesktop(bool filter)
     if (d->filterByVirtualDesktop != filter) {
         d->filterByVirtualDesktop = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterByVirtualDesktopChanged();
     }
@@ -165,7 +424,7 @@ void TaskFilterProxyModel::setFilterByScreen(bool filter)
     if (d->filterByScreen != filter) {
         d->filterByScreen = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterByScreenChanged();
     }
@@ -181,7 +440,7 @@ void TaskFilterProxyModel::setFilterByActivity(bool filter)
     if (d->filterByActivity != filter) {
         d->filterByActivity = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterByActivityChanged();
     }
@@ -199,7 +458,7 @@ void TaskFilterProxyModel::setFilterByRegion(RegionFilterMode::Mode mode)
     }
 
     d->filterByRegion = mode;
-    invalidateFilter();
+    d->invalidateFilter();
     Q_EMIT filterByActivityChanged();
 }
 
@@ -215,7 +474,7 @@ void TaskFilterProxyModel::setFilterMinimized(bool filter)
     }
 
     d->filterMinimized = filter;
-    invalidateFilter();
+    d->invalidateFilter();
 
     Q_EMIT filterMinimizedChanged();
 }
@@ -230,7 +489,7 @@ void TaskFilterProxyModel::setFilterNotMinimized(bool filter)
     if (d->filterNotMinimized != filter) {
         d->filterNotMinimized = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterNotMinimizedChanged();
     }
@@ -246,7 +505,7 @@ void TaskFilterProxyModel::setFilterNotMaximized(bool filter)
     if (d->filterNotMaximized != filter) {
         d->filterNotMaximized = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterNotMaximizedChanged();
     }
@@ -262,7 +521,7 @@ void TaskFilterProxyModel::setFilterHidden(bool filter)
     if (d->filterHidden != filter) {
         d->filterHidden = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterHiddenChanged();
     }
@@ -278,7 +537,7 @@ void TaskFilterProxyModel::setFilterSkipTaskbar(bool filter)
     if (d->filterSkipTaskbar != filter) {
         d->filterSkipTaskbar = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterSkipTaskbarChanged();
     }
@@ -294,7 +553,7 @@ void TaskFilterProxyModel::setFilterSkipPager(bool filter)
     if (d->filterSkipPager != filter) {
         d->filterSkipPager = filter;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT filterSkipPagerChanged();
     }
@@ -310,7 +569,7 @@ void TaskFilterProxyModel::setDemandingAttentionSkipsFilters(bool skip)
     if (d->demandingAttentionSkipsFilters != skip) {
         d->demandingAttentionSkipsFilters = skip;
 
-        invalidateFilter();
+        d->invalidateFilter();
 
         Q_EMIT demandingAttentionSkipsFiltersChanged();
     }
@@ -329,23 +588,22 @@ bool TaskFilterProxyModel::acceptsRow(int sourceRow) const
         return false;
     }
 
+    const Private::RowData &data = d->rowData(sourceIdx);
+
     // Filter tasks that are not to be shown on the task bar.
-    if (d->filterSkipTaskbar && sourceIdx.data(AbstractTasksModel::SkipTaskbar).toBool()) {
+    if (d->filterSkipTaskbar && data.skipTaskbar) {
         return false;
     }
 
     // Filter tasks that are not to be shown on the pager.
-    if (d->filterSkipPager && sourceIdx.data(AbstractTasksModel::SkipPager).toBool()) {
+    if (d->filterSkipPager && data.skipPager) {
         return false;
     }
 
     // Filter by virtual desktop.
     if (d->filterByVirtualDesktop && !d->virtualDesktop.isNull()) {
-        if (!sourceIdx.data(AbstractTasksModel::IsOnAllVirtualDesktops).toBool()
-            && (!d->demandingAttentionSkipsFilters || !sourceIdx.data(AbstractTasksModel::IsDemandingAttention).toBool())) {
-            const QVariantList &virtualDesktops = sourceIdx.data(AbstractTasksModel::VirtualDesktops).toList();
-
-            if (!virtualDesktops.isEmpty() && !virtualDesktops.contains(d->virtualDesktop)) {
+        if (!data.onAllVirtualDesktops && (!d->demandingAttentionSkipsFilters || !data.demandingAttention)) {
+            if (!data.virtualDesktops.isEmpty() && !data.virtualDesktops.contains(d->virtualDesktop)) {
                 return false;
             }
         }
@@ -353,16 +611,14 @@ bool TaskFilterProxyModel::acceptsRow(int sourceRow) const
 
     // Filter by screen.
     if (d->filterByScreen && d->screenGeometry.isValid()) {
-        const QRect &screenGeometry = sourceIdx.data(AbstractTasksModel::ScreenGeometry).toRect();
-
-        if (screenGeometry.isValid() && screenGeometry != d->screenGeometry) {
+        if (data.screenGeometry.isValid() && data.screenGeometry != d->screenGeometry) {
             return false;
         }
     }
 
     // Filter by region
     if (d->filterByRegion != RegionFilterMode::Mode::Disabled && d->regionGeometry.isValid()) {
-        QRect windowGeometry = sourceIdx.data(AbstractTasksModel::Geometry).toRect();
+        const QRect &windowGeometry = data.geometry;
 
         QRect regionGeometry = d->regionGeometry;
 #if HAVE_X11
@@ -404,11 +660,9 @@ bool TaskFilterProxyModel::acceptsRow(int sourceRow) const
 
     // Filter by activity.
     if (d->filterByActivity && !d->activity.isEmpty()) {
-        if (!d->demandingAttentionSkipsFilters || !sourceIdx.data(AbstractTasksModel::IsDemandingAttention).toBool()) {
-            const QVariant &activities = sourceIdx.data(AbstractTasksModel::Activities);
-
-            if (!activities.isNull()) {
-                const QStringList l = activities.toStringList();
+        if (!d->demandingAttentionSkipsFilters || !data.demandingAttention) {
+            if (data.hasActivities) {
+                const QStringList &l = data.activities;
 
                 if (!l.isEmpty() && !l.contains(NULL_UUID) && !l.contains(d->activity)) {
                     return false;
@@ -419,36 +673,28 @@ bool TaskFilterProxyModel::acceptsRow(int sourceRow) const
 
     // Filter not minimized.
     if (d->filterNotMinimized) {
-        bool isMinimized = sourceIdx.data(AbstractTasksModel::IsMinimized).toBool();
-
-        if (!isMinimized) {
+        if (!data.minimized) {
             return false;
         }
     }
 
     // Filter out minimized windows
     if (d->filterMinimized) {
-        const bool isMinimized = sourceIdx.data(AbstractTasksModel::IsMinimized).toBool();
-
-        if (isMinimized) {
+        if (data.minimized) {
             return false;
         }
     }
 
     // Filter not maximized.
     if (d->filterNotMaximized) {
-        bool isMaximized = sourceIdx.data(AbstractTasksModel::IsMaximized).toBool();
-
-        if (!isMaximized) {
+        if (!data.maximized) {
             return false;
         }
     }
 
     // Filter hidden.
     if (d->filterHidden) {
-        bool isHidden = sourceIdx.data(AbstractTasksModel::IsHidden).toBool();
-
-        if (isHidden) {
+        if (data.hidden) {
             return false;
         }
     }
@@ -460,6 +706,11 @@ bool TaskFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &so
 {
     Q_UNUSED(sourceParent)
 
+    // Nothing the filter looks at changed, so the row stays in or out.
+    if (d->unaffectedRows && sourceRow >= d->unaffectedRows->first && sourceRow <= d->unaffectedRows->second) {
+        return mapFromSource(sourceModel()->index(sourceRow, 0)).isValid();
+    }
+
     return acceptsRow(sourceRow);
 }
 
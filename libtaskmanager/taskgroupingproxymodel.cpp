@@ -9,8 +9,12 @@
 #include "tasktools.h"
 
 #include <QDateTime>
+#include <QHash>
 #include <QSet>
 
+#include <algorithm>
+#include <utility>
+
 namespace TaskManager
 {
 class Q_DECL_HIDDEN TaskGroupingProxyModel::Private
@@ -26,6 +30,13 @@ public:
     int windowTasksThreshold = -1;
 
     QList<QList<int> *> rowMap;
+    // Reverse lookups for rowMap, kept in sync by the helpers below: the sub-list
+    // each source row is in, and the top-level row of each sub-list.
+    QList<QList<int> *> sourceRowMap;
+    QHash<const QList<int> *, int> groupRows;
+    // Removing a row leaves the groupRows entries past it off by one. They're renumbered
+    // in one go once one of them is looked up, see groupRow(), -1 if none are off.
+    int firstStaleGroupRow = -1;
 
     QSet<QString> blacklistedAppIds;
     QSet<QString> blacklistedLauncherUrls;
@@ -41,8 +52,14 @@ public:
     void sourceModelAboutToBeReset();
     void sourceModelReset();
     void sourceDataChanged(QModelIndex topLeft, QModelIndex bottomRight, const QList<int> &roles = QList<int>());
+    void emitDataChanged(const QModelIndex &parent, QList<int> rows, const QList<int> &roles);
     void adjustMap(int anchor, int delta);
 
+    void appendToMap(QList<int> *sourceRows);
+    void removeFromMap(int row);
+    int groupRow(const QList<int> *sourceRows);
+    void addToGroup(int row, int sourceRow);
+    void clearMap();
     void rebuildMap();
     bool shouldGroupTasks();
     void checkGrouping(bool silent = false);
@@ -62,7 +79,7 @@ TaskGroupingProxyModel::Private::Private(TaskGroupingProxyModel *q)
 
 TaskGroupingProxyModel::Private::~Private()
 {
-    qDeleteAll(rowMap);
+    clearMap();
 }
 
 bool TaskGroupingProxyModel::Private::isGroup(int row)
@@ -115,13 +132,14 @@ void TaskGroupingProxyModel::Private::sourceRowsInserted(const QModelIndex &pare
     }
 
     adjustMap(start, (end - start) + 1);
+    sourceRowMap.insert(start, (end - start) + 1, nullptr);
 
     bool shouldGroup = shouldGroupTasks(); // Can be slightly expensive; cache return value.
 
     for (int i = start; i <= end; ++i) {
         if (!shouldGroup || !tryToGroup(q->sourceModel()->index(i, 0))) {
             q->beginInsertRows(QModelIndex(), rowMap.count(), rowMap.count());
-            rowMap.append(new QList<int>{i});
+            appendToMap(new QList<int>{i});
             q->endInsertRows();
         }
     }
@@ -137,39 +155,42 @@ void TaskGroupingProxyModel::Private::sourceRowsAboutToBeRemoved(const QModelInd
     }
 
     for (int i = first; i <= last; ++i) {
-        for (int j = 0; j < rowMap.count(); ++j) {
-            const QList<int> *sourceRows = rowMap.at(j);
-            const int mapIndex = sourceRows->indexOf(i);
-
-            if (mapIndex != -1) {
-                // Remove top-level item.
-                if (sourceRows->count() == 1) {
-                    q->beginRemoveRows(QModelIndex(), j, j);
-                    delete rowMap.takeAt(j);
-                    q->endRemoveRows();
-                    // Dissolve group.
-                } else if (sourceRows->count() == 2) {
-                    const QModelIndex parent = q->index(j, 0);
-                    q->beginRemoveRows(parent, 0, 1);
-                    rowMap[j]->remove(mapIndex);
-                    q->endRemoveRows();
-
-                    // We're no longer a group parent.
-                    Q_EMIT q->dataChanged(parent, parent);
-                    // Remove group member.
-                } else {
-                    const QModelIndex parent = q->index(j, 0);
-                    q->beginRemoveRows(parent, mapIndex, mapIndex);
-                    rowMap[j]->remove(mapIndex);
-                    q->endRemoveRows();
-
-                    // Various roles of the parent evaluate child data, and the
-                    // child list has changed.
-                    Q_EMIT q->dataChanged(parent, parent);
-                }
+        QList<int> *sourceRows = sourceRowMap.value(i);
 
-                break;
-            }
+        if (!sourceRows) {
+            continue;
+        }
+
+        const int j = groupRow(sourceRows);
+        const int mapIndex = sourceRows->indexOf(i);
+        Q_ASSERT(j != -1 && mapIndex != -1);
+
+        // Remove top-level item.
+        if (sourceRows->count() == 1) {
+            q->beginRemoveRows(QModelIndex(), j, j);
+            removeFromMap(j);
+            q->endRemoveRows();
+            // Dissolve group.
+        } else if (sourceRows->count() == 2) {
+            const QModelIndex parent = q->index(j, 0);
+            q->beginRemoveRows(parent, 0, 1);
+            sourceRows->remove(mapIndex);
+            sourceRowMap[i] = nullptr;
+            q->endRemoveRows();
+
+            // We're no longer a group parent.
+            Q_EMIT q->dataChanged(parent, parent);
+            // Remove group member.
+        } else {
+            const QModelIndex parent = q->index(j, 0);
+            q->beginRemoveRows(parent, mapIndex, mapIndex);
+            sourceRows->remove(mapIndex);
+            sourceRowMap[i] = nullptr;
+            q->endRemoveRows();
+
+            // Various roles of the parent evaluate child data, and the
+            // child list has changed.
+            Q_EMIT q->dataChanged(parent, parent);
         }
     }
 }
@@ -182,6 +203,7 @@ void TaskGroupingProxyModel::Private::sourceRowsRemoved(const QModelIndex &paren
     }
 
     adjustMap(start + 1, -((end - start) + 1));
+    sourceRowMap.remove(start, (end - start) + 1);
 
     checkGrouping();
 }
@@ -200,12 +222,27 @@ void TaskGroupingProxyModel::Private::sourceModelReset()
 
 void TaskGroupingProxyModel::Private::sourceDataChanged(QModelIndex topLeft, QModelIndex bottomRight, const QList<int> &roles)
 {
+    // Collect the changed rows per parent, so neighbours are announced as one range
+    // instead of row by row.
+    QList<int> topLevelRows;
+    QHash<int, QList<int>> childRows;
+
+    auto flush = [&]() {
+        emitDataChanged(QModelIndex(), std::exchange(topLevelRows, {}), roles);
+
+        for (auto it = childRows.cbegin(); it != childRows.cend(); ++it) {
+            emitDataChanged(q->index(it.key(), 0), it.value(), roles);
+        }
+
+        childRows.clear();
+    };
+
     for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
         const QModelIndex &sourceIndex = q->sourceModel()->index(i, 0);
         QModelIndex proxyIndex = q->mapFromSource(sourceIndex);
 
         if (!proxyIndex.isValid()) {
-            return;
+            continue;
         }
 
         const QModelIndex parent = proxyIndex.parent();
@@ -215,50 +252,146 @@ void TaskGroupingProxyModel::Private::sourceDataChanged(QModelIndex topLeft, QMo
         // TODO: Some roles do not need to bubble up as they fall through to the first
         // child in data(); it _might_ be worth adding constraints here later.
         if (parent.isValid()) {
-            Q_EMIT q->dataChanged(parent, parent, roles);
+            topLevelRows.append(parent.row());
+            childRows[parent.row()].append(proxyIndex.row());
+            continue;
         }
 
         // When Private::groupDemandingAttention is false, tryToGroup() exempts tasks
         // which demand attention from being grouped. Therefore if this task is no longer
         // demanding attention, we need to try grouping it now.
-        if (!parent.isValid() && !groupDemandingAttention && roles.contains(AbstractTasksModel::IsDemandingAttention)
+        if (!groupDemandingAttention && roles.contains(AbstractTasksModel::IsDemandingAttention)
             && !sourceIndex.data(AbstractTasksModel::IsDemandingAttention).toBool()) {
+            // Grouping moves rows around, so announce what was collected so far first.
+            flush();
+
             if (shouldGroupTasks() && tryToGroup(sourceIndex)) {
                 q->beginRemoveRows(QModelIndex(), proxyIndex.row(), proxyIndex.row());
-                delete rowMap.takeAt(proxyIndex.row());
+                removeFromMap(proxyIndex.row());
                 q->endRemoveRows();
-            } else {
-                Q_EMIT q->dataChanged(proxyIndex, proxyIndex, roles);
+                continue;
             }
-        } else {
-            Q_EMIT q->dataChanged(proxyIndex, proxyIndex, roles);
         }
+
+        topLevelRows.append(proxyIndex.row());
+    }
+
+    flush();
+}
+
+void TaskGroupingProxyModel::Private::emitDataChanged(const QModelIndex &parent, QList<int> rows, const QList<int> &roles)
+{
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    for (qsizetype first = 0; first < rows.size();) {
+        qsizetype last = first;
+
+        while (last + 1 < rows.size() && rows.at(last + 1) == rows.at(last) + 1) {
+            ++last;
+        }
+
+        Q_EMIT q->dataChanged(q->index(rows.at(first), 0, parent), q->index(rows.at(last), 0, parent), roles);
+        first = last + 1;
     }
 }
 
 void TaskGroupingProxyModel::Private::adjustMap(int anchor, int delta)
 {
-    for (int i = 0; i < rowMap.count(); ++i) {
-        QList<int> *sourceRows = rowMap.at(i);
-        for (auto it = sourceRows->begin(); it != sourceRows->end(); ++it) {
-            if ((*it) >= anchor) {
-                *it += delta;
-            }
+    // Only the source rows at or past the anchor are visited, via sourceRowMap. Source rows
+    // are unique across the map, so shifting away from the anchor's far end first never
+    // leaves two entries with the same value for indexOf() to confuse.
+    auto shift = [this, delta](int sourceRow) {
+        if (QList<int> *sourceRows = sourceRowMap.at(sourceRow)) {
+            (*sourceRows)[sourceRows->indexOf(sourceRow)] += delta;
+        }
+    };
+
+    if (delta > 0) {
+        for (int i = sourceRowMap.count() - 1; i >= anchor; --i) {
+            shift(i);
+        }
+    } else {
+        for (int i = anchor; i < sourceRowMap.count(); ++i) {
+            shift(i);
         }
     }
 }
 
-void TaskGroupingProxyModel::Private::rebuildMap()
+void TaskGroupingProxyModel::Private::appendToMap(QList<int> *sourceRows)
+{
+    groupRows.insert(sourceRows, rowMap.count());
+    rowMap.append(sourceRows);
+
+    for (int sourceRow : std::as_const(*sourceRows)) {
+        sourceRowMap[sourceRow] = sourceRows;
+    }
+}
+
+void TaskGroupingProxyModel::Private::removeFromMap(int row)
+{
+    QList<int> *sourceRows = rowMap.takeAt(row);
+    groupRows.remove(sourceRows);
+
+    // Source rows that were grouped elsewhere already point at their new sub-list.
+    for (int sourceRow : std::as_const(*sourceRows)) {
+        if (sourceRowMap.value(sourceRow) == sourceRows) {
+            sourceRowMap[sourceRow] = nullptr;
+        }
+    }
+
+    if (row < rowMap.count() && (firstStaleGroupRow == -1 || row < firstStaleGroupRow)) {
+        firstStaleGroupRow = row;
+    }
+
+    delete sourceRows;
+}
+
+int TaskGroupingProxyModel::Private::groupRow(const QList<int> *sourceRows)
+{
+    const int row = groupRows.value(sourceRows, -1);
+
+    // Entries are only ever too large, by the number of rows removed before them since.
+    if (row == -1 || firstStaleGroupRow == -1 || row < firstStaleGroupRow) {
+        return row;
+    }
+
+    for (int i = firstStaleGroupRow; i < rowMap.count(); ++i) {
+        groupRows[rowMap.at(i)] = i;
+    }
+
+    firstStaleGroupRow = -1;
+
+    return groupRows.value(sourceRows, -1);
+}
+
+void TaskGroupingProxyModel::Private::addToGroup(int row, int sourceRow)
+{
+    rowMap[row]->append(sourceRow);
+    sourceRowMap[sourceRow] = rowMap.at(row);
+}
+
+void TaskGroupingProxyModel::Private::clearMap()
 {
     qDeleteAll(rowMap);
     rowMap.clear();
+    sourceRowMap.clear();
+    groupRows.clear();
+    firstStaleGroupRow = -1;
+}
+
+void TaskGroupingProxyModel::Private::rebuildMap()
+{
+    clearMap();
 
     const int rows = q->sourceModel()->rowCount();
 
     rowMap.reserve(rows);
+    sourceRowMap.resize(rows);
+    groupRows.reserve(rows);
 
     for (int i = 0; i < rows; ++i) {
-        rowMap.append(new QList<int>{i});
+        appendToMap(new QList<int>{i});
     }
 
     checkGrouping(true /* silent */);
@@ -303,7 +436,7 @@ void TaskGroupingProxyModel::Private::checkGrouping(bool silent)
 
             if (tryToGroup(q->sourceModel()->index(rowMap.at(i)->constFirst(), 0), silent)) {
                 q->beginRemoveRows(QModelIndex(), i, i);
-                delete rowMap.takeAt(i); // Safe since we're iterating backwards.
+                removeFromMap(i); // Safe since we're iterating backwards.
                 q->endRemoveRows();
             }
         }
@@ -384,7 +517,7 @@ bool TaskGroupingProxyModel::Private::tryToGroup(const QModelIndex &sourceIndex,
                 }
             }
 
-            rowMap[i]->append(sourceIndex.row());
+            addToGroup(i, sourceIndex.row());
 
             if (!silent) {
                 q->endInsertRows();
@@ -419,7 +552,7 @@ void TaskGroupingProxyModel::Private::formGroupFor(const QModelIndex &index)
 
         if (tryToGroup(sourceIndex)) {
             q->beginRemoveRows(QModelIndex(), i, i);
-            delete rowMap.takeAt(i); // Safe since we're iterating backwards.
+            removeFromMap(i); // Safe since we're iterating backwards.
             q->endRemoveRows();
         }
     }
@@ -457,7 +590,7 @@ void TaskGroupingProxyModel::Private::breakGroupFor(const QModelIndex &index, bo
     }
 
     for (int i = 0; i < extraChildren.count(); ++i) {
-        rowMap.append(new QList<int>{extraChildren.at(i)});
+        appendToMap(new QList<int>{extraChildren.at(i)});
     }
 
     if (!silent) {
@@ -497,7 +630,7 @@ QModelIndex TaskGroupingProxyModel::parent(const QModelIndex &child) const
     if (child.internalPointer() == nullptr) {
         return QModelIndex();
     } else {
-        const int parentRow = d->rowMap.indexOf(static_cast<QList<int> *>(child.internalPointer()));
+        const int parentRow = d->groupRow(static_cast<const QList<int> *>(child.internalPointer()));
 
         if (parentRow != -1) {
             return index(parentRow, 0);
@@ -517,25 +650,29 @@ QModelIndex TaskGroupingProxyModel::mapFromSource(const QModelIndex &sourceIndex
         return QModelIndex();
     }
 
-    for (int i = 0; i < d->rowMap.count(); ++i) {
-        const QList<int> *sourceRows = d->rowMap.at(i);
-        const int childIndex = sourceRows->indexOf(sourceIndex.row());
-        const QModelIndex parent = index(i, 0);
-
-        if (childIndex == 0) {
-            // If the sub-list we found the source row in is larger than 1 (i.e. part
-            // of a group, map to the logical child item instead of the parent item
-            // the source row also stands in for. The parent is therefore unreachable
-            // from mapToSource().
-            if (d->isGroup(i)) {
-                return index(0, 0, parent);
-                // Otherwise map to the top-level item.
-            } else {
-                return parent;
-            }
-        } else if (childIndex != -1) {
-            return index(childIndex, 0, parent);
+    const QList<int> *sourceRows = d->sourceRowMap.value(sourceIndex.row());
+
+    if (!sourceRows) {
+        return QModelIndex();
+    }
+
+    const int row = d->groupRow(sourceRows);
+    const int childIndex = sourceRows->indexOf(sourceIndex.row());
+    const QModelIndex parent = index(row, 0);
+
+    if (childIndex == 0) {
+        // If the sub-list we found the source row in is larger than 1 (i.e. part
+        // of a group, map to the logical child item instead of the parent item
+        // the source row also stands in for. The parent is therefore unreachable
+        // from mapToSource().
+        if (d->isGroup(row)) {
+            return index(0, 0, parent);
+            // Otherwise map to the top-level item.
+        } else {
+            return parent;
         }
+    } else if (childIndex != -1) {
+        return index(childIndex, 0, parent);
     }
 
     return QModelIndex();
@@ -782,8 +919,7 @@ void TaskGroupingProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
         connect(sourceModel, &QSortFilterProxyModel::modelReset, this, std::bind(&TaskGroupingProxyModel::Private::sourceModelReset, dd));
         connect(sourceModel, &QSortFilterProxyModel::dataChanged, this, std::bind(&TaskGroupingProxyModel::Private::sourceDataChanged, dd, _1, _2, _3));
     } else {
-        qDeleteAll(d->rowMap);
-        d->rowMap.clear();
+        d->clearMap();
     }
 
     endResetModel();
@@ -21,10 +21,12 @@
 
 #include <QDateTime>
 #include <QGuiApplication>
+#include <QHash>
 #include <QList>
 #include <QTimer>
 #include <QUrl>
 
+#include <algorithm>
 #include <numeric>
 #include <optional>
 
@@ -59,6 +61,8 @@ public:
     bool launcherSortingDirty = false;
     bool launcherCheckNeeded = false;
     QList<int> sortedPreFilterRows;
+    // Inverse of sortedPreFilterRows, rebuilt on demand by sortMapPosition().
+    mutable QList<int> sortMapPositions;
     QList<int> sortRowInsertQueue;
     bool sortRowInsertQueueStale = false;
     std::shared_ptr<VirtualDesktopInfo> virtualDesktopInfo;
@@ -71,6 +75,27 @@ public:
     bool usedByQml = false;
     bool componentComplete = false;
 
+    // The data lessThan() looks at, fetched once per row instead of once per comparison.
+    struct SortKey {
+        int row = -1;
+        // Position in sortedPreFilterRows before a sort of the map, see TasksModelLessThan.
+        int mapPosition = -1;
+        bool isLauncher = false;
+        QUrl launcherUrl;
+        QDateTime lastActivated;
+        bool isOnAllVirtualDesktops = false;
+        QVariantList virtualDesktops;
+        QRect geometry;
+        QStringList activities;
+        QString sortString;
+    };
+
+    // Sort keys of the rows of q->sourceModel(), indexed by row. Empty entries are
+    // yet to be computed, or were dropped because the row's data changed.
+    mutable QList<std::optional<SortKey>> sortKeys;
+    // Positions in the launcher list, by launcher url. Cleared before the list changes.
+    mutable QHash<QUrl, int> launcherPositions;
+
     void initModels();
     void initLauncherTasksModel();
     void updateAnyTaskDemandsAttention();
@@ -80,8 +105,13 @@ public:
     QModelIndex preFilterIndex(const QModelIndex &sourceIndex) const;
     void updateActivityTaskCounts();
     void forceResort();
-    bool lessThan(const QModelIndex &left, const QModelIndex &right, bool sortOnlyLaunchers = false) const;
-    std::optional<bool> lessThanByVirtualDesktop(const QModelIndex &left, const QModelIndex &right) const;
+    int sortMapPosition(int preFilterRow) const;
+    void trackSortKeys(QAbstractItemModel *model);
+    SortKey makeSortKey(const QModelIndex &index) const;
+    SortKey sortKey(const QModelIndex &index) const;
+    int launcherPosition(const QUrl &url) const;
+    bool lessThan(const SortKey &left, const SortKey &right, bool sortOnlyLaunchers = false) const;
+    std::optional<bool> lessThanByVirtualDesktop(const SortKey &left, const SortKey &right) const;
 
 private:
     TasksModel *const q;
@@ -91,22 +121,30 @@ class TasksModel::TasksModelLessThan
 {
 public:
     inline TasksModelLessThan(const QAbstractItemModel *s, TasksModel *p, bool sortOnlyLaunchers)
-        : sourceModel(s)
-        , tasksModel(p)
+        : tasksModel(p)
         , sortOnlyLaunchers(sortOnlyLaunchers)
     {
+        // Sorting compares every row several times over, so look at its data only once.
+        keys.reserve(s->rowCount());
+
+        for (int i = 0; i < s->rowCount(); ++i) {
+            keys.append(tasksModel->d->makeSortKey(s->index(i, 0)));
+
+            // Sorting shuffles the map, so sort by where the rows were in it beforehand.
+            if (sortOnlyLaunchers) {
+                keys.last().mapPosition = tasksModel->d->sortMapPosition(i);
+            }
+        }
     }
 
     inline bool operator()(int r1, int r2) const
     {
-        QModelIndex i1 = sourceModel->index(r1, 0);
-        QModelIndex i2 = sourceModel->index(r2, 0);
-        return tasksModel->d->lessThan(i1, i2, sortOnlyLaunchers);
+        return tasksModel->d->lessThan(keys.at(r1), keys.at(r2), sortOnlyLaunchers);
     }
 
 private:
-    const QAbstractItemModel *sourceModel;
     const TasksModel *tasksModel;
+    QList<TasksModel::Private::SortKey> keys;
     bool sortOnlyLaunchers;
 };
 
@@ -283,6 +321,7 @@ void TasksModel::Private::initModels()
 
     groupingProxyModel = new TaskGroupingProxyModel(q);
     groupingProxyModel->setSourceModel(filterProxyModel);
+    trackSortKeys(groupingProxyModel);
     QObject::connect(groupingProxyModel, &TaskGroupingProxyModel::groupModeChanged, q, &TasksModel::groupModeChanged);
     QObject::connect(groupingProxyModel, &TaskGroupingProxyModel::blacklistedAppIdsChanged, q, &TasksModel::groupingAppIdBlacklistChanged);
     QObject::connect(groupingProxyModel, &TaskGroupingProxyModel::blacklistedLauncherUrlsChanged, q, &TasksModel::groupingLauncherUrlBlacklistChanged);
@@ -469,6 +508,20 @@ void TasksModel::Private::initLauncherTasksModel()
     }
 
     launcherTasksModel = new LauncherTasksModel(q);
+
+    // The launcher list changes between these signals and the matching ones QSortFilterProxyModel
+    // resorts on, so our cached launcher positions are never stale when lessThan() looks at them.
+    const auto clearLauncherPositions = [this]() {
+        launcherPositions.clear();
+    };
+
+    QObject::connect(launcherTasksModel, &QAbstractItemModel::rowsAboutToBeInserted, q, clearLauncherPositions);
+    QObject::connect(launcherTasksModel, &QAbstractItemModel::rowsAboutToBeRemoved, q, clearLauncherPositions);
+    QObject::connect(launcherTasksModel, &QAbstractItemModel::rowsAboutToBeMoved, q, clearLauncherPositions);
+    QObject::connect(launcherTasksModel, &QAbstractItemModel::layoutAboutToBeChanged, q, clearLauncherPositions);
+    QObject::connect(launcherTasksModel, &QAbstractItemModel::modelAboutToBeReset, q, clearLauncherPositions);
+    QObject::connect(launcherTasksModel, &LauncherTasksModel::launcherListChanged, q, clearLauncherPositions);
+
     QObject::connect(launcherTasksModel, &LauncherTasksModel::launcherListChanged, q, &TasksModel::launcherListChanged);
     QObject::connect(launcherTasksModel, &LauncherTasksModel::launcherListChanged, q, &TasksModel::updateLauncherCount);
 
@@ -679,8 +732,10 @@ void TasksModel::Private::updateGroupInline()
 
         flattenGroupsProxyModel = new FlattenTaskGroupsProxyModel(q);
         flattenGroupsProxyModel->setSourceModel(groupingProxyModel);
+        trackSortKeys(flattenGroupsProxyModel);
 
         abstractTasksSourceModel = flattenGroupsProxyModel;
+        sortKeys.clear();
         q->setSourceModel(flattenGroupsProxyModel);
 
         if (sortMode == SortManual) {
@@ -695,6 +750,7 @@ void TasksModel::Private::updateGroupInline()
         groupingProxyModel->setWindowTasksThreshold(groupingWindowTasksThreshold);
 
         abstractTasksSourceModel = groupingProxyModel;
+        sortKeys.clear();
         q->setSourceModel(groupingProxyModel);
 
         delete flattenGroupsProxyModel;
@@ -769,10 +825,10 @@ void TasksModel::Private::forceResort()
     q->setDynamicSortFilter(true);
 }
 
-std::optional<bool> TasksModel::Private::lessThanByVirtualDesktop(const QModelIndex &left, const QModelIndex &right) const
+std::optional<bool> TasksModel::Private::lessThanByVirtualDesktop(const SortKey &left, const SortKey &right) const
 {
-    const bool leftAll = left.data(AbstractTasksModel::IsOnAllVirtualDesktops).toBool();
-    const bool rightAll = right.data(AbstractTasksModel::IsOnAllVirtualDesktops).toBool();
+    const bool leftAll = left.isOnAllVirtualDesktops;
+    const bool rightAll = right.isOnAllVirtualDesktops;
 
     if (leftAll && !rightAll) {
         return true;
@@ -783,11 +839,10 @@ std::optional<bool> TasksModel::Private::lessThanByVirtualDesktop(const QModelIn
     }
 
     if (!leftAll && !rightAll) {
-        const auto getDesktop = [this](const QModelIndex &model) {
-            const QVariantList modelDesktops = model.data(AbstractTasksModel::VirtualDesktops).toList();
+        const auto getDesktop = [this](const SortKey &key) {
             QVariant modelDesktop;
             int modelDesktopPos = virtualDesktopInfo->numberOfDesktops();
-            for (const QVariant &desktop : modelDesktops) {
+            for (const QVariant &desktop : key.virtualDesktops) {
                 const int desktopPos = virtualDesktopInfo->position(desktop);
 
                 if (desktopPos <= modelDesktopPos) {
@@ -814,22 +869,171 @@ std::optional<bool> TasksModel::Private::lessThanByVirtualDesktop(const QModelIn
     return std::nullopt;
 }
 
-bool TasksModel::Private::lessThan(const QModelIndex &left, const QModelIndex &right, bool sortOnlyLaunchers) const
+int TasksModel::Private::sortMapPosition(int preFilterRow) const
+{
+    // Stands in for sortedPreFilterRows.indexOf(), which is linear and which sorting
+    // in manual sort mode needs twice per comparison. The map is changed in many places,
+    // so rather than keeping the inverse up to date everywhere, we check whether
+    // its answer is still right and rebuild it when it isn't.
+    int pos = sortMapPositions.value(preFilterRow, -1);
+
+    if (pos == -1 || sortedPreFilterRows.value(pos, -1) != preFilterRow) {
+        sortMapPositions.fill(-1, sortedPreFilterRows.count());
+
+        for (int i = 0; i < sortedPreFilterRows.count(); ++i) {
+            const int row = sortedPreFilterRows.at(i);
+
+            if (row >= sortMapPositions.count()) {
+                sortMapPositions.resize(row + 1, -1);
+            }
+
+            sortMapPositions[row] = i;
+        }
+
+        pos = sortMapPositions.value(preFilterRow, -1);
+    }
+
+    return pos;
+}
+
+void TasksModel::Private::trackSortKeys(QAbstractItemModel *model)
+{
+    // Must be called before the model becomes our source model, so the cached keys
+    // are updated before QSortFilterProxyModel resorts in response to the same signals.
+    QObject::connect(model,
+                     &QAbstractItemModel::dataChanged,
+                     q,
+                     [this, model](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+                         if (model != q->sourceModel() || topLeft.parent().isValid() || sortKeys.isEmpty()) {
+                             return;
+                         }
+
+                         static const QList<int> sortRoles{Qt::DisplayRole,
+                                                           AbstractTasksModel::AppName,
+                                                           AbstractTasksModel::IsLauncher,
+                                                           AbstractTasksModel::LauncherUrlWithoutIcon,
+                                                           AbstractTasksModel::LastActivated,
+                                                           AbstractTasksModel::IsOnAllVirtualDesktops,
+                                                           AbstractTasksModel::VirtualDesktops,
+                                                           AbstractTasksModel::Geometry,
+                                                           AbstractTasksModel::Activities};
+
+                         if (!roles.isEmpty() && std::none_of(roles.cbegin(), roles.cend(), [](int role) {
+                                 return sortRoles.contains(role);
+                             })) {
+                             return;
+                         }
+
+                         const int last = std::min(bottomRight.row(), int(sortKeys.count()) - 1);
+
+                         for (int i = topLeft.row(); i <= last; ++i) {
+                             sortKeys[i].reset();
+                         }
+                     });
+
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, q, [this, model](const QModelIndex &parent, int first, int last) {
+        if (model != q->sourceModel() || parent.isValid() || first > sortKeys.count()) {
+            return;
+        }
+
+        sortKeys.insert(first, (last - first) + 1, std::nullopt);
+    });
+
+    QObject::connect(model, &QAbstractItemModel::rowsRemoved, q, [this, model](const QModelIndex &parent, int first, int last) {
+        if (model != q->sourceModel() || parent.isValid() || first >= sortKeys.count()) {
+            return;
+        }
+
+        sortKeys.remove(first, (std::min(last, int(sortKeys.count()) - 1) - first) + 1);
+    });
+
+    const auto clearSortKeys = [this, model]() {
+        if (model == q->sourceModel()) {
+            sortKeys.clear();
+        }
+    };
+
+    QObject::connect(model, &QAbstractItemModel::rowsMoved, q, clearSortKeys);
+    QObject::connect(model, &QAbstractItemModel::layoutChanged, q, clearSortKeys);
+    QObject::connect(model, &QAbstractItemModel::modelReset, q, clearSortKeys);
+}
+
+TasksModel::Private::SortKey TasksModel::Private::makeSortKey(const QModelIndex &index) const
+{
+    SortKey key;
+    key.row = index.row();
+    key.isLauncher = index.data(AbstractTasksModel::IsLauncher).toBool();
+    key.launcherUrl = index.data(AbstractTasksModel::LauncherUrlWithoutIcon).toUrl();
+
+    // Check if the task is in a group
+    const QModelIndex topMost = index.parent().isValid() ? index.parent() : index;
+    key.lastActivated = topMost.data(AbstractTasksModel::LastActivated).toDateTime();
+    if (!key.lastActivated.isValid()) {
+        key.lastActivated = index.data(Qt::DisplayRole).toDateTime();
+    }
+
+    key.isOnAllVirtualDesktops = index.data(AbstractTasksModel::IsOnAllVirtualDesktops).toBool();
+    key.virtualDesktops = index.data(AbstractTasksModel::VirtualDesktops).toList();
+    key.geometry = index.data(AbstractTasksModel::Geometry).value<QRect>();
+    key.activities = index.data(AbstractTasksModel::Activities).toStringList();
+
+    key.sortString = index.data(AbstractTasksModel::AppName).toString();
+    if (key.sortString.isEmpty()) {
+        key.sortString = index.data(Qt::DisplayRole).toString();
+    }
+
+    return key;
+}
+
+TasksModel::Private::SortKey TasksModel::Private::sortKey(const QModelIndex &index) const
+{
+    if (index.model() != q->sourceModel() || index.parent().isValid()) {
+        return makeSortKey(index);
+    }
+
+    if (index.row() >= sortKeys.count()) {
+        sortKeys.resize(q->sourceModel()->rowCount());
+    }
+
+    std::optional<SortKey> &cached = sortKeys[index.row()];
+
+    if (!cached) {
+        cached = makeSortKey(index);
+    }
+
+    // The row of a cached key goes stale as rows are inserted or removed before it.
+    cached->row = index.row();
+
+    return *cached;
+}
+
+int TasksModel::Private::launcherPosition(const QUrl &url) const
+{
+    auto it = launcherPositions.constFind(url);
+
+    if (it == launcherPositions.constEnd()) {
+        it = launcherPositions.insert(url, q->launcherPosition(url));
+    }
+
+    return it.value();
+}
+
+bool TasksModel::Private::lessThan(const SortKey &left, const SortKey &right, bool sortOnlyLaunchers) const
 {
     // Launcher tasks go first.
     // When launchInPlace is enabled, startup and window tasks are sorted
     // as the launchers they replace (see also move()).
 
     if (separateLaunchers) {
-        const bool leftIsLauncher = left.data(AbstractTasksModel::IsLauncher).toBool();
-        const bool rightIsLauncher = right.data(AbstractTasksModel::IsLauncher).toBool();
+        const bool leftIsLauncher = left.isLauncher;
+        const bool rightIsLauncher = right.isLauncher;
 
         if (leftIsLauncher && rightIsLauncher) {
-            return (left.row() < right.row());
+            return (left.row < right.row);
         }
 
-        const int leftPos = q->launcherPosition(left.data(AbstractTasksModel::LauncherUrlWithoutIcon).toUrl());
-        const int rightPos = q->launcherPosition(right.data(AbstractTasksModel::LauncherUrlWithoutIcon).toUrl());
+        const int leftPos = launcherPosition(left.launcherUrl);
+        const int rightPos = launcherPosition(right.launcherUrl);
 
         if (leftIsLauncher && !rightIsLauncher) {
             if (launchInPlace) {
@@ -865,13 +1069,13 @@ bool TasksModel::Private::lessThan(const QModelIndex &left, const QModelIndex &r
 
     // If told to stop after launchers we fall through to the existing map if it exists.
     if (sortOnlyLaunchers && !sortedPreFilterRows.isEmpty()) {
-        return (sortedPreFilterRows.indexOf(left.row()) < sortedPreFilterRows.indexOf(right.row()));
+        return (left.mapPosition < right.mapPosition);
     }
 
     // Sort other cases by sort mode.
     switch (sortMode) {
     case SortDisabled: {
-        return (left.row() < right.row());
+        return (left.row < right.row);
     }
 
     case SortWindowPositionHorizontal: {
@@ -880,8 +1084,8 @@ bool TasksModel::Private::lessThan(const QModelIndex &left, const QModelIndex &r
             return *result;
         }
 
-        const QRect leftGeom = left.data(AbstractTasksModel::Geometry).value<QRect>();
-        const QRect rightGeom = right.data(AbstractTasksModel::Geometry).value<QRect>();
+        const QRect &leftGeom = left.geometry;
+        const QRect &rightGeom = right.geometry;
 
         if (leftGeom.x() != rightGeom.x()) {
             if (QGuiApplication::isRightToLeft()) {
@@ -898,18 +1102,8 @@ bool TasksModel::Private::lessThan(const QModelIndex &left, const QModelIndex &r
     }
 
     case SortLastActivated: {
-        const auto getSortDateTime = [](const QModelIndex &model) {
-            // Check if the task is in a group
-            const QModelIndex topMost = model.parent().isValid() ? model.parent() : model;
-            QDateTime sortDateTime = topMost.data(AbstractTasksModel::LastActivated).toDateTime();
-            if (!sortDateTime.isValid()) {
-                sortDateTime = model.data(Qt::DisplayRole).toDateTime();
-            }
-            return sortDateTime;
-        };
-
-        const QDateTime leftSortDateTime = getSortDateTime(left);
-        const QDateTime rightSortDateTime = getSortDateTime(right);
+        const QDateTime &leftSortDateTime = left.lastActivated;
+        const QDateTime &rightSortDateTime = right.lastActivated;
 
         if (leftSortDateTime != rightSortDateTime) {
             // Move latest to leftmost
@@ -933,9 +1127,8 @@ bool TasksModel::Private::lessThan(const QModelIndex &left, const QModelIndex &r
         // activity. This will sort tasks by comparing a cumulative score made
         // up of the task counts for each activity a task is assigned to, and
         // otherwise fall through to alphabetical sorting.
-        const auto getScore = [this](const QModelIndex &model) {
-            const QStringList activities = model.data(AbstractTasksModel::Activities).toStringList();
-            const int score = std::accumulate(activities.cbegin(), activities.cend(), -1, [this](int a, const QString &activity) {
+        const auto getScore = [this](const SortKey &key) {
+            const int score = std::accumulate(key.activities.cbegin(), key.activities.cend(), -1, [this](int a, const QString &activity) {
                 return a + activityTaskCounts[activity];
             });
             return score;
@@ -980,23 +1173,11 @@ bool TasksModel::Private::lessThan(const QModelIndex &left, const QModelIndex &r
         // insertion order", only swapping out AppName for DisplayRole (i.e. window
         // title) when necessary.
 
-        QString leftSortString = left.data(AbstractTasksModel::AppName).toString();
-
-        if (leftSortString.isEmpty()) {
-            leftSortString = left.data(Qt::DisplayRole).toString();
-        }
-
-        QString rightSortString = right.data(AbstractTasksModel::AppName).toString();
-
-        if (rightSortString.isEmpty()) {
-            rightSortString = right.data(Qt::DisplayRole).toString();
-        }
-
-        const int sortResult = leftSortString.localeAwareCompare(rightSortString);
+        const int sortResult = left.sortString.localeAwareCompare(right.sortString);
 
         // If the string are identical fall back to source model (creation/append) order.
         if (sortResult == 0) {
-            return (left.row() < right.row());
+            return (left.row < right.row);
         }
 
         return (sortResult < 0);
@@ -2075,10 +2256,10 @@ bool TasksModel::lessThan(const QModelIndex &left, const QModelIndex &right) con
 {
     // In manual sort mode, sort by map.
     if (d->sortMode == SortManual) {
-        return (d->sortedPreFilterRows.indexOf(d->preFilterIndex(left).row()) < d->sortedPreFilterRows.indexOf(d->preFilterIndex(right).row()));
+        return (d->sortMapPosition(d->preFilterIndex(left).row()) < d->sortMapPosition(d->preFilterIndex(right).row()));
     }
 
-    return d->lessThan(left, right);
+    return d->lessThan(d->sortKey(left), d->sortKey(right));
 }
 
 std::shared_ptr<VirtualDesktopInfo> TasksModel::virtualDesktopInfo() const
@@ -7,6 +7,7 @@
 
 #include "tasktools.h"
 #include "abstracttasksmodel.h"
+#include "tasktools_p.h"
 
 #include <ranges>
 
@@ -25,6 +26,7 @@
 
 #include <QDir>
 #include <QGuiApplication>
+#include <QHash>
 #include <QRegularExpression>
 #include <QScreen>
 #include <QUrlQuery>
@@ -50,8 +52,34 @@ static const QString appropriateCaption(const KService::Ptr &service)
 
 namespace TaskManager
 {
+static QRegularExpression rewriteRuleRegExp(const QString &pattern)
+{
+    // Rewrite rules are evaluated for every new window, compile each pattern only once.
+    static QHash<QString, QRegularExpression> regExps;
+
+    auto it = regExps.find(pattern);
+    if (it == regExps.end()) {
+        it = regExps.emplace(pattern, pattern);
+        it->optimize();
+    }
+
+    return *it;
+}
+
 AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon)
 {
+    return appDataFromUrl(url, fallbackIcon, nullptr);
+}
+
+AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon, QString *desktopPath)
+{
+    auto setDesktopPath = [desktopPath](const QString &path) {
+        if (desktopPath) {
+            *desktopPath = path;
+        }
+    };
+    setDesktopPath(QString());
+
     AppData data;
     data.url = url;
 
@@ -81,6 +109,7 @@ AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon)
             data.name = service->name();
             data.genericName = appropriateCaption(service);
             data.id = service->storageId();
+            setDesktopPath(service->entryPath());
 
             if (data.icon.isNull()) {
                 data.icon = QIcon::fromTheme(service->icon());
@@ -105,11 +134,14 @@ AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon)
                 data.name = service->name();
                 data.genericName = appropriateCaption(service);
                 data.id = service->storageId();
+                setDesktopPath(service->entryPath());
 
                 if (data.icon.isNull()) {
                     data.icon = QIcon::fromTheme(service->icon());
                 }
             } else {
+                setDesktopPath(url.toLocalFile());
+
                 KDesktopFile f(url.toLocalFile());
                 if (f.tryExec()) {
                     data.name = f.readName();
@@ -160,6 +192,7 @@ AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon)
             data.name = service->name();
             data.genericName = appropriateCaption(service);
             data.id = service->storageId();
+            setDesktopPath(desktopFile);
 
             if (data.icon.isNull()) {
                 data.icon = QIcon::fromTheme(service->icon());
@@ -327,7 +360,7 @@ QUrl windowUrlFromMetadata(const QString &appId, quint32 pid, const KSharedConfi
                             continue;
                         }
 
-                        QRegularExpression regExp(ruleGroup.readEntry(QStringLiteral("Match")));
+                        const QRegularExpression regExp = rewriteRuleRegExp(ruleGroup.readEntry(QStringLiteral("Match")));
                         const auto match = regExp.match(matchProperty);
 
                         if (match.hasMatch()) {
@@ -0,0 +1,18 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include "tasktools.h"
+
+namespace TaskManager
+{
+/**
+ * appDataFromUrl(), which also sets @p desktopPath to the desktop file the data
+ * was read from, or to an empty string if there is none.
+ */
+AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon, QString *desktopPath);
+}
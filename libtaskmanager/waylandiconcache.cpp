@@ -0,0 +1,147 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "waylandiconcache.h"
+#include "libtaskmanager_debug.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QScopeGuard>
+
+#include <cerrno>
+#include <sys/poll.h>
+#include <unistd.h>
+
+namespace TaskManager
+{
+namespace
+{
+// Enough for the icons of a few hundred applications at the sizes a taskbar uses.
+constexpr qsizetype s_defaultMaxCost = 32 * 1024 * 1024;
+
+qsizetype iconCost(const QIcon &icon, const QByteArray &data)
+{
+    qsizetype cost = 0;
+
+    for (const auto sizes = icon.availableSizes(); const QSize &size : sizes) {
+        cost += qsizetype(size.width()) * size.height() * 4;
+    }
+
+    // Scalable icons don't tell their size, go by what they took to send.
+    return std::max(cost, data.size());
+}
+}
+
+WaylandIconCache::WaylandIconCache()
+    : m_icons(s_defaultMaxCost)
+{
+}
+
+WaylandIconCache::~WaylandIconCache()
+{
+    qCDebug(TASKMANAGER_DEBUG) << "Window icons:" << m_stats.hits << "cache hits," << m_stats.misses << "misses," << m_stats.debounced << "updates skipped";
+}
+
+std::shared_ptr<WaylandIconCache> WaylandIconCache::instance()
+{
+    static std::weak_ptr<WaylandIconCache> s_instance;
+    if (s_instance.expired()) {
+        std::shared_ptr<WaylandIconCache> ptr(new WaylandIconCache);
+        s_instance = ptr;
+        return ptr;
+    }
+    return s_instance.lock();
+}
+
+QIcon WaylandIconCache::read(int fd, const QString &windowUuid)
+{
+    auto closeGuard = qScopeGuard([fd]() {
+        ::close(fd);
+    });
+    pollfd pollFd;
+    pollFd.fd = fd;
+    pollFd.events = POLLIN;
+    QByteArray data;
+    while (true) {
+        int ready = poll(&pollFd, 1, 1000);
+        if (ready < 0 && errno != EINTR) {
+            qCWarning(TASKMANAGER_DEBUG) << "polling for icon of window" << windowUuid << "failed";
+            return QIcon();
+        } else if (ready == 0) {
+            qCWarning(TASKMANAGER_DEBUG) << "time out polling for icon of window" << windowUuid;
+            return QIcon();
+        } else {
+            char buffer[4096];
+            int n = ::read(fd, buffer, sizeof(buffer));
+            if (n < 0) {
+                qCWarning(TASKMANAGER_DEBUG) << "error reading icon of window" << windowUuid;
+                return QIcon();
+            } else if (n > 0) {
+                data.append(buffer, n);
+            } else {
+                return lookup(data);
+            }
+        }
+    }
+}
+
+QIcon WaylandIconCache::lookup(const QByteArray &data)
+{
+    const QByteArray key = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stats.bytesRead += data.size();
+
+        if (const QIcon *icon = m_icons.object(key)) {
+            ++m_stats.hits;
+            return *icon;
+        }
+    }
+
+    // Decode without holding the lock, other windows' icons may be read meanwhile.
+    QIcon icon;
+    QDataStream ds(data);
+    ds >> icon;
+
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.misses;
+
+    // Another thread may have decoded the same icon in the meantime, share its copy.
+    if (const QIcon *cached = m_icons.object(key)) {
+        return *cached;
+    }
+
+    if (!icon.isNull()) {
+        m_icons.insert(key, new QIcon(icon), iconCost(icon, data));
+    }
+
+    return icon;
+}
+
+void WaylandIconCache::countDebounced()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.debounced;
+}
+
+WaylandIconCache::Stats WaylandIconCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats stats = m_stats;
+    stats.icons = m_icons.count();
+    stats.cost = m_icons.totalCost();
+    stats.maxCost = m_icons.maxCost();
+    return stats;
+}
+
+void WaylandIconCache::setMaxCost(qsizetype bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_icons.setMaxCost(bytes);
+}
+}
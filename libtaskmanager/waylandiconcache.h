@@ -0,0 +1,81 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <QByteArray>
+#include <QCache>
+#include <QIcon>
+#include <QMutex>
+
+namespace TaskManager
+{
+/**
+ * Process-wide cache of the icons Wayland windows send, keyed by their content.
+ *
+ * Windows of the same application usually send the same icon. Looking icons up
+ * by a hash of their serialized data makes those windows share one QIcon, across
+ * all task models, instead of each holding a copy of its own, and skips decoding
+ * icons that were seen before.
+ *
+ * Can be used from any thread.
+ *
+ * @internal
+ */
+class WaylandIconCache
+{
+public:
+    struct Stats {
+        /// Icons found in the cache
+        quint64 hits = 0;
+        /// Icons that had to be decoded
+        quint64 misses = 0;
+        /// Icon updates of windows that were skipped because another one followed quickly
+        quint64 debounced = 0;
+        /// Serialized icon data received from the compositor
+        quint64 bytesRead = 0;
+        qsizetype icons = 0;
+        /// Estimated memory used by the cached icons
+        qsizetype cost = 0;
+        qsizetype maxCost = 0;
+    };
+
+    ~WaylandIconCache();
+
+    static std::shared_ptr<WaylandIconCache> instance();
+
+    /**
+     * Reads a serialized icon from @p fd until the compositor closes it, and returns
+     * the cached icon with the same data, or the decoded one. Closes @p fd.
+     * Blocks, so call it from a worker thread.
+     */
+    QIcon read(int fd, const QString &windowUuid);
+
+    /**
+     * Counts an icon update that didn't need to be read, see Stats::debounced.
+     */
+    void countDebounced();
+
+    Stats stats() const;
+
+    /**
+     * The estimated memory, in bytes, cached icons may use. Icons in use by windows
+     * stay alive when they're evicted, they are only decoded again when sent again.
+     */
+    void setMaxCost(qsizetype bytes);
+
+private:
+    WaylandIconCache();
+
+    QIcon lookup(const QByteArray &data);
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray, QIcon> m_icons;
+    Stats m_stats;
+};
+}
@@ -5,12 +5,13 @@
 */
 
 #include "waylandtasksmodel.h"
+#include "appdatacache.h"
+#include "datachangecoalescer.h"
 #include "libtaskmanager_debug.h"
 #include "tasktools.h"
 #include "virtualdesktopinfo.h"
+#include "waylandiconcache.h"
 
-#include <KDirWatch>
-#include <KSharedConfig>
 #include <KWindowSystem>
 
 #include <qwayland-plasma-window-management.h>
@@ -23,6 +24,7 @@
 #include <QQuickItem>
 #include <QQuickWindow>
 #include <QSet>
+#include <QTimer>
 #include <QUrl>
 #include <QUuid>
 #include <QWaylandClientExtension>
@@ -31,9 +33,10 @@
 #include <qpa/qplatformwindow_p.h>
 
 #include <fcntl.h>
-#include <sys/poll.h>
 #include <unistd.h>
 
+using namespace std::chrono_literals;
+
 namespace TaskManager
 {
 
@@ -45,6 +48,15 @@ public:
         : org_kde_plasma_window(id)
         , uuid(uuid)
     {
+        iconThrottle.setSingleShot(true);
+        iconThrottle.setInterval(100ms);
+        connect(&iconThrottle, &QTimer::timeout, this, [this] {
+            if (iconChangePending) {
+                iconChangePending = false;
+                readIcon();
+                iconThrottle.start();
+            }
+        });
     }
     ~PlasmaWindow()
     {
@@ -119,57 +131,25 @@ protected:
     }
     void org_kde_plasma_window_icon_changed() override
     {
-        int pipeFds[2];
-        if (pipe2(pipeFds, O_CLOEXEC) != 0) {
-            qCWarning(TASKMANAGER_DEBUG) << "failed creating pipe";
+        // Some clients change their icon many times in a row, e.g. to show progress.
+        // Read the first change right away, and only the latest one of any that
+        // follow within the interval.
+        if (iconThrottle.isActive()) {
+            if (iconChangePending) {
+                iconCache->countDebounced();
+            }
+            iconChangePending = true;
             return;
         }
-        get_icon(pipeFds[1]);
-        ::close(pipeFds[1]);
-        auto readIcon = [uuid = uuid](int fd) {
-            auto closeGuard = qScopeGuard([fd]() {
-                ::close(fd);
-            });
-            pollfd pollFd;
-            pollFd.fd = fd;
-            pollFd.events = POLLIN;
-            QByteArray data;
-            while (true) {
-                int ready = poll(&pollFd, 1, 1000);
-                if (ready < 0 && errno != EINTR) {
-                    qCWarning(TASKMANAGER_DEBUG) << "polling for icon of window" << uuid << "failed";
-                    return QIcon();
-                } else if (ready == 0) {
-                    qCWarning(TASKMANAGER_DEBUG) << "time out polling for icon of window" << uuid;
-                    return QIcon();
-                } else {
-                    char buffer[4096];
-                    int n = read(fd, buffer, sizeof(buffer));
-                    if (n < 0) {
-                        qCWarning(TASKMANAGER_DEBUG) << "error reading icon of window" << uuid;
-                        return QIcon();
-                    } else if (n > 0) {
-                        data.append(buffer, n);
-                    } else {
-                        QIcon icon;
-                        QDataStream ds(data);
-                        ds >> icon;
-                        return icon;
-                    }
-                }
-            }
-        };
-        QFuture<QIcon> future = QtConcurrent::run(readIcon, pipeFds[0]);
-        auto watcher = new QFutureWatcher<QIcon>();
-        connect(watcher, &QFutureWatcher<QIcon>::finished, this, [this, watcher] {
-            icon = watcher->future().result();
-            Q_EMIT iconChanged();
-        });
-        connect(watcher, &QFutureWatcher<QIcon>::finished, watcher, &QObject::deleteLater);
-        watcher->setFuture(future);
+
+        readIcon();
+        iconThrottle.start();
     }
     void org_kde_plasma_window_themed_icon_name_changed(const QString &name) override
     {
+        // Supersedes any icon still being read.
+        ++iconSerial;
+        iconChangePending = false;
         icon = QIcon::fromTheme(name);
         Q_EMIT iconChanged();
     }
@@ -342,6 +322,38 @@ private:
 
     QMetaObject::Connection parentWindowUnmappedConnection;
     QMetaObject::Connection parentWindowDestroyedConnection;
+
+    void readIcon()
+    {
+        int pipeFds[2];
+        if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+            qCWarning(TASKMANAGER_DEBUG) << "failed creating pipe";
+            return;
+        }
+        get_icon(pipeFds[1]);
+        ::close(pipeFds[1]);
+        QFuture<QIcon> future = QtConcurrent::run(
+            [iconCache = iconCache, uuid = uuid](int fd) {
+                return iconCache->read(fd, uuid);
+            },
+            pipeFds[0]);
+        auto watcher = new QFutureWatcher<QIcon>();
+        connect(watcher, &QFutureWatcher<QIcon>::finished, this, [this, watcher, serial = ++iconSerial] {
+            // A later read may have finished first.
+            if (serial != iconSerial) {
+                return;
+            }
+            icon = watcher->future().result();
+            Q_EMIT iconChanged();
+        });
+        connect(watcher, &QFutureWatcher<QIcon>::finished, watcher, &QObject::deleteLater);
+        watcher->setFuture(future);
+    }
+
+    std::shared_ptr<WaylandIconCache> iconCache = WaylandIconCache::instance();
+    QTimer iconThrottle;
+    bool iconChangePending = false;
+    quint64 iconSerial = 0;
 };
 
 class PlasmaWindowManagement;
@@ -444,8 +456,8 @@ public:
     // key=leader, values=transient children
     QMultiHash<PlasmaWindow *, PlasmaWindow *> transientsDemandingAttention;
     std::unique_ptr<PlasmaWindowManagement> windowManagement;
-    KSharedConfig::Ptr rulesConfig;
-    KDirWatch *configWatcher = nullptr;
+    std::shared_ptr<AppDataCache> sharedAppData;
+    DataChangeCoalescer<PlasmaWindow *> dataChanges;
     VirtualDesktopInfo *virtualDesktopInfo = nullptr;
     static QUuid uuid;
     QList<QString> stackingOrder;
@@ -464,6 +476,7 @@ public:
 
     void dataChanged(PlasmaWindow *window, int role);
     void dataChanged(PlasmaWindow *window, const QList<int> &roles);
+    void emitDataChanged(PlasmaWindow *window, const QList<int> &roles);
 
 private:
     WaylandTasksModel *const q;
@@ -472,47 +485,55 @@ private:
 QUuid WaylandTasksModel::Private::uuid = QUuid::createUuid();
 
 WaylandTasksModel::Private::Private(WaylandTasksModel *q)
-    : q(q)
+    : dataChanges([this](PlasmaWindow *window, const QList<int> &roles) {
+        emitDataChanged(window, roles);
+    })
+    , q(q)
 {
 }
 
 void WaylandTasksModel::Private::init()
 {
-    auto clearCacheAndRefresh = [this] {
+    // Roles satisfied from app data cache.
+    const QList<int> appDataRoles{Qt::DecorationRole,
+                                  AbstractTasksModel::AppId,
+                                  AbstractTasksModel::AppName,
+                                  AbstractTasksModel::GenericName,
+                                  AbstractTasksModel::LauncherUrl,
+                                  AbstractTasksModel::LauncherUrlWithoutIcon,
+                                  AbstractTasksModel::CanLaunchNewInstance,
+                                  AbstractTasksModel::SkipTaskbar};
+
+    auto clearCacheAndRefresh = [this, appDataRoles] {
         if (windows.empty()) {
             return;
         }
 
         appDataCache.clear();
 
-        // Emit changes of all roles satisfied from app data cache.
-        Q_EMIT q->dataChanged(q->index(0, 0),
-                              q->index(windows.size() - 1, 0),
-                              QList<int>{Qt::DecorationRole,
-                                         AbstractTasksModel::AppId,
-                                         AbstractTasksModel::AppName,
-                                         AbstractTasksModel::GenericName,
-                                         AbstractTasksModel::LauncherUrl,
-                                         AbstractTasksModel::LauncherUrlWithoutIcon,
-                                         AbstractTasksModel::CanLaunchNewInstance,
-                                         AbstractTasksModel::SkipTaskbar});
+        Q_EMIT q->dataChanged(q->index(0, 0), q->index(windows.size() - 1, 0), appDataRoles);
     };
 
-    rulesConfig = KSharedConfig::openConfig(QStringLiteral("taskmanagerrulesrc"));
-    configWatcher = new KDirWatch(q);
+    sharedAppData = AppDataCache::instance();
 
-    for (const QString &location : QStandardPaths::standardLocations(QStandardPaths::ConfigLocation)) {
-        configWatcher->addFile(location + QLatin1String("/taskmanagerrulesrc"));
-    }
+    QObject::connect(sharedAppData.get(), &AppDataCache::rulesChanged, q, clearCacheAndRefresh);
 
-    auto rulesConfigChange = [this, clearCacheAndRefresh] {
-        rulesConfig->reparseConfiguration();
-        clearCacheAndRefresh();
-    };
+    // Only refresh the windows whose desktop file changed.
+    QObject::connect(sharedAppData.get(), &AppDataCache::appDataChanged, q, [this, appDataRoles](const QSet<QUrl> &urls) {
+        for (std::size_t i = 0; i < windows.size(); ++i) {
+            PlasmaWindow *window = windows[i].get();
+            auto it = appDataCache.constFind(window);
+
+            if (it == appDataCache.constEnd() || !urls.contains(it->url)) {
+                continue;
+            }
+
+            appDataCache.erase(it);
 
-    QObject::connect(configWatcher, &KDirWatch::dirty, rulesConfigChange);
-    QObject::connect(configWatcher, &KDirWatch::created, rulesConfigChange);
-    QObject::connect(configWatcher, &KDirWatch::deleted, rulesConfigChange);
+            const QModelIndex idx = q->index(i, 0);
+            Q_EMIT q->dataChanged(idx, idx, appDataRoles);
+        }
+    });
 
     virtualDesktopInfo = new VirtualDesktopInfo(q);
 
@@ -529,6 +550,7 @@ void WaylandTasksModel::Private::initWayland()
 
     QObject::connect(windowManagement.get(), &PlasmaWindowManagement::activeChanged, q, [this] {
         q->beginResetModel();
+        dataChanges.clear();
         windows.clear();
         q->endResetModel();
     });
@@ -576,6 +598,8 @@ void WaylandTasksModel::Private::addWindow(PlasmaWindow *window)
             const std::unique_ptr<PlasmaWindow> removedWindow = std::move(*it);
             windows.erase(it);
 
+            dataChanges.remove(window);
+
             transientsDemandingAttention.remove(window);
             appDataCache.remove(window);
             lastActivated.remove(window);
@@ -820,7 +844,7 @@ const AppData &WaylandTasksModel::Private::appData(PlasmaWindow *window)
         return *it;
     }
 
-    return *appDataCache.emplace(window, appDataFromUrl(windowUrlFromMetadata(window->appId, window->pid, rulesConfig, window->resourceName)));
+    return *appDataCache.emplace(window, sharedAppData->appData(sharedAppData->windowUrl(window->appId, window->pid, window->resourceName)));
 }
 
 QIcon WaylandTasksModel::Private::icon(PlasmaWindow *window)
@@ -852,15 +876,15 @@ QString WaylandTasksModel::Private::groupMimeType()
 
 void WaylandTasksModel::Private::dataChanged(PlasmaWindow *window, int role)
 {
-    auto it = findWindow(window);
-    if (it == windows.end()) {
-        return;
-    }
-    QModelIndex idx = q->index(it - windows.begin());
-    Q_EMIT q->dataChanged(idx, idx, QList<int>{role});
+    dataChanges.dataChanged(window, QList<int>{role});
 }
 
 void WaylandTasksModel::Private::dataChanged(PlasmaWindow *window, const QList<int> &roles)
+{
+    dataChanges.dataChanged(window, roles);
+}
+
+void WaylandTasksModel::Private::emitDataChanged(PlasmaWindow *window, const QList<int> &roles)
 {
     auto it = findWindow(window);
     if (it == windows.end()) {
@@ -5,6 +5,7 @@
 */
 
 #include "windowtasksmodel.h"
+#include "windowtasksmodel_p.h"
 
 #include <config-X11.h>
 
@@ -17,6 +18,13 @@
 
 namespace TaskManager
 {
+static AbstractTasksModel *s_testSourceTasksModel = nullptr;
+
+void setWindowTasksSourceModelForTesting(AbstractTasksModel *model)
+{
+    s_testSourceTasksModel = model;
+}
+
 class Q_DECL_HIDDEN WindowTasksModel::Private
 {
 public:
@@ -46,13 +54,19 @@ WindowTasksModel::Private::~Private()
     --instanceCount;
 
     if (!instanceCount) {
-        delete sourceTasksModel;
+        if (sourceTasksModel != s_testSourceTasksModel) {
+            delete sourceTasksModel;
+        }
         sourceTasksModel = nullptr;
     }
 }
 
 void WindowTasksModel::Private::initSourceTasksModel()
 {
+    if (!sourceTasksModel && s_testSourceTasksModel) {
+        sourceTasksModel = s_testSourceTasksModel;
+    }
+
     if (!sourceTasksModel && KWindowSystem::isPlatformWayland()) {
         sourceTasksModel = new WaylandTasksModel();
     }
@@ -0,0 +1,24 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#pragma once
+
+#include "taskmanager_export.h"
+
+namespace TaskManager
+{
+class AbstractTasksModel;
+
+/**
+ * Makes window tasks models created from now on present @p model instead of the
+ * windows of the windowing system, so tests and benchmarks can run without one.
+ * Pass nullptr to go back. The caller keeps ownership of @p model, and it has to
+ * be set before any window tasks model exists.
+ *
+ * @internal
+ */
+TASKMANAGER_EXPORT void setWindowTasksSourceModelForTesting(AbstractTasksModel *model);
+}
@@ -6,15 +6,13 @@
 */
 
 #include "xwindowtasksmodel.h"
+#include "appdatacache.h"
+#include "datachangecoalescer.h"
 #include "tasktools.h"
-#include "xwindowsystemeventbatcher.h"
 
 #include <KDesktopFile>
-#include <KDirWatch>
 #include <KIconLoader>
 #include <KService>
-#include <KSharedConfig>
-#include <KSycoca>
 #include <KWindowInfo>
 #include <KX11Extras>
 
@@ -25,15 +23,10 @@
 #include <QGuiApplication>
 #include <QIcon>
 #include <QSet>
-#include <QTimer>
 #include <QUrlQuery>
 
-#include <chrono>
-
 #include <X11/Xlib.h>
 
-using namespace std::chrono_literals;
-
 namespace X11Info
 {
 [[nodiscard]] inline auto display()
@@ -79,9 +72,8 @@ public:
     QHash<WId, QDateTime> lastActivated;
     QList<WId> cachedStackingOrder;
     WId activeWindow = -1;
-    KSharedConfig::Ptr rulesConfig;
-    KDirWatch *configWatcher = nullptr;
-    QTimer sycocaChangeTimer;
+    std::shared_ptr<AppDataCache> sharedAppData;
+    DataChangeCoalescer<WId> dataChanges;
 
     void init();
     void addWindow(WId window);
@@ -89,6 +81,7 @@ public:
     void windowChanged(WId window, NET::Properties properties, NET::Properties2 properties2);
     void transientChanged(WId window, NET::Properties properties, NET::Properties2 properties2);
     void dataChanged(WId window, const QList<int> &roles);
+    void emitDataChanged(WId window, const QList<int> &roles);
 
     KWindowInfo *windowInfo(WId window);
     const AppData &appData(WId window);
@@ -107,7 +100,10 @@ private:
 };
 
 XWindowTasksModel::Private::Private(XWindowTasksModel *q)
-    : q(q)
+    : dataChanges([this](WId window, const QList<int> &roles) {
+        emitDataChanged(window, roles);
+    })
+    , q(q)
 {
 }
 
@@ -119,64 +115,59 @@ XWindowTasksModel::Private::~Private()
 
 void XWindowTasksModel::Private::init()
 {
-    auto clearCacheAndRefresh = [this] {
+    // Roles satisfied from app data cache.
+    const QList<int> appDataRoles{Qt::DecorationRole,
+                                  AbstractTasksModel::AppId,
+                                  AbstractTasksModel::AppName,
+                                  AbstractTasksModel::GenericName,
+                                  AbstractTasksModel::LauncherUrl,
+                                  AbstractTasksModel::LauncherUrlWithoutIcon,
+                                  AbstractTasksModel::CanLaunchNewInstance,
+                                  AbstractTasksModel::SkipTaskbar};
+
+    auto clearCacheAndRefresh = [this, appDataRoles] {
         if (!windows.count()) {
             return;
         }
 
         appDataCache.clear();
 
-        // Emit changes of all roles satisfied from app data cache.
-        Q_EMIT q->dataChanged(q->index(0, 0),
-                              q->index(windows.count() - 1, 0),
-                              QList<int>{Qt::DecorationRole,
-                                         AbstractTasksModel::AppId,
-                                         AbstractTasksModel::AppName,
-                                         AbstractTasksModel::GenericName,
-                                         AbstractTasksModel::LauncherUrl,
-                                         AbstractTasksModel::LauncherUrlWithoutIcon,
-                                         AbstractTasksModel::CanLaunchNewInstance,
-                                         AbstractTasksModel::SkipTaskbar});
+        Q_EMIT q->dataChanged(q->index(0, 0), q->index(windows.count() - 1, 0), appDataRoles);
     };
 
     cachedStackingOrder = KX11Extras::stackingOrder();
 
-    sycocaChangeTimer.setSingleShot(true);
-    sycocaChangeTimer.setInterval(100ms);
+    sharedAppData = AppDataCache::instance();
 
-    QObject::connect(&sycocaChangeTimer, &QTimer::timeout, q, clearCacheAndRefresh);
-
-    QObject::connect(KSycoca::self(), &KSycoca::databaseChanged, q, [this]() {
-        sycocaChangeTimer.start();
-    });
+    QObject::connect(sharedAppData.get(), &AppDataCache::rulesChanged, q, clearCacheAndRefresh);
 
-    rulesConfig = KSharedConfig::openConfig(QStringLiteral("taskmanagerrulesrc"));
-    configWatcher = new KDirWatch(q);
+    // Only refresh the windows whose desktop file changed.
+    QObject::connect(sharedAppData.get(), &AppDataCache::appDataChanged, q, [this, appDataRoles](const QSet<QUrl> &urls) {
+        for (int i = 0; i < windows.count(); ++i) {
+            const WId window = windows.at(i);
+            auto it = appDataCache.constFind(window);
 
-    for (const auto locations = QStandardPaths::standardLocations(QStandardPaths::ConfigLocation); const QString &location : locations) {
-        configWatcher->addFile(location + QLatin1String("/taskmanagerrulesrc"));
-    }
-
-    auto rulesConfigChange = [this, clearCacheAndRefresh] {
-        rulesConfig->reparseConfiguration();
-        clearCacheAndRefresh();
-    };
+            if (it == appDataCache.constEnd() || !urls.contains(it->url)) {
+                continue;
+            }
 
-    QObject::connect(configWatcher, &KDirWatch::dirty, rulesConfigChange);
-    QObject::connect(configWatcher, &KDirWatch::created, rulesConfigChange);
-    QObject::connect(configWatcher, &KDirWatch::deleted, rulesConfigChange);
+            appDataCache.erase(it);
+            usingFallbackIcon.remove(window);
 
-    auto windowSystem = new XWindowSystemEventBatcher(q);
+            const QModelIndex idx = q->index(i, 0);
+            Q_EMIT q->dataChanged(idx, idx, appDataRoles);
+        }
+    });
 
-    QObject::connect(windowSystem, &XWindowSystemEventBatcher::windowAdded, q, [this](WId window) {
+    QObject::connect(KX11Extras::self(), &KX11Extras::windowAdded, q, [this](WId window) {
         addWindow(window);
     });
 
-    QObject::connect(windowSystem, &XWindowSystemEventBatcher::windowRemoved, q, [this](WId window) {
+    QObject::connect(KX11Extras::self(), &KX11Extras::windowRemoved, q, [this](WId window) {
         removeWindow(window);
     });
 
-    QObject::connect(windowSystem, &XWindowSystemEventBatcher::windowChanged, q, [this](WId window, NET::Properties properties, NET::Properties2 properties2) {
+    QObject::connect(KX11Extras::self(), &KX11Extras::windowChanged, q, [this](WId window, NET::Properties properties, NET::Properties2 properties2) {
         windowChanged(window, properties, properties2);
     });
 
@@ -264,6 +255,9 @@ void XWindowTasksModel::Private::addWindow(WId window)
 
 void XWindowTasksModel::Private::removeWindow(WId window)
 {
+    // Pending changes of a destroyed window would make no sense.
+    dataChanges.remove(window);
+
     const int row = windows.indexOf(window);
 
     if (row != -1) {
@@ -427,6 +421,11 @@ void XWindowTasksModel::Private::windowChanged(WId window, NET::Properties prope
 }
 
 void XWindowTasksModel::Private::dataChanged(WId window, const QList<int> &roles)
+{
+    dataChanges.dataChanged(window, roles);
+}
+
+void XWindowTasksModel::Private::emitDataChanged(WId window, const QList<int> &roles)
 {
     const int i = windows.indexOf(window);
 
@@ -459,7 +458,7 @@ const AppData &XWindowTasksModel::Private::appData(WId window)
         return *it;
     }
 
-    AppData data = appDataFromUrl(windowUrl(window));
+    AppData data = sharedAppData->appData(windowUrl(window));
 
     // If we weren't able to derive a launcher URL from the window meta data,
     // fall back to WM_CLASS Class string as app id. This helps with apps we
@@ -550,7 +549,7 @@ QUrl XWindowTasksModel::Private::windowUrl(WId window)
         }
     }
 
-    return windowUrlFromMetadata(QString::fromLocal8Bit(info->windowClassClass()), info->pid(), rulesConfig, QString::fromLocal8Bit(info->windowClassName()));
+    return sharedAppData->windowUrl(QString::fromLocal8Bit(info->windowClassClass()), info->pid(), QString::fromLocal8Bit(info->windowClassName()));
 }
 
 QUrl XWindowTasksModel::Private::launcherUrl(WId window, bool encodeFallbackIcon)